@@ -74,7 +74,8 @@ int TFAudioSampleRecognizer::init(const char* model_path, const char* label_path
         return 0;
     }
 
-    TfLiteInterpreterOptionsSetNumThreads(options, 2);
+    budget_owner = model_path;
+    TfLiteInterpreterOptionsSetNumThreads(options, ThreadBudget::get_instance()->assign(budget_owner, "tflite"));
     TfLiteInterpreterOptionsSetErrorReporter(options, default_error_reporter, NULL);
 
     interpreter = TfLiteInterpreterCreate(model, options);
@@ -140,6 +141,11 @@ void TFAudioSampleRecognizer::clear()
     interpreter = NULL;
     input_tensor = NULL;
     metal_delegate = NULL;
+
+    if (!budget_owner.empty()) {
+        ThreadBudget::get_instance()->release(budget_owner, "tflite");
+        budget_owner.clear();
+    }
 }
 
 int TFAudioSampleRecognizer::detect(cv::Mat* input, int& current_id, bool is_draw)
@@ -166,15 +172,16 @@ int TFAudioSampleRecognizer::detect(cv::Mat* input, int& current_id, bool is_dra
         }
     }
 
-    DetectionItem* item = new DetectionItem();
+    DetectionItem* item = create_detection();
     item->id = current_id;
     item->detector_id = id;
     current_id++;
     item->kind = ObjectDetectorKind::AUDIO_RECOGNIZER_TFLITE;
-    if (detected_index >= 0)
-        item->label = trim(labels[detected_index]);
+    const std::string* label = get_label(detected_index);
+    if (label != nullptr)
+        item->set_label(label);
     else
-        item->label = "none";
+        item->set_label("none");
 
     item->class_id = detected_index;
     item->score = cur;
@@ -252,7 +259,7 @@ void TFAudioSampleRecognizer::draw_detection(cv::Mat* detect_frame, DetectionIte
     }
 
     cv::resize(frame, frame, cv::Size(640, 640), 0, 0, cv::INTER_AREA);
-    draw_label(frame, detection->label, 10, 10, background_color, color);
+    draw_label(frame, detection->get_label(), 10, 10, background_color, color);
 
     detect_frame->upload(frame);
 
@@ -28,6 +28,7 @@
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "IObjectDetector.h"
+#include "ThreadBudget.h"
 
 namespace cs
 {
@@ -57,6 +58,7 @@ namespace cs
 		TfLiteInterpreter* interpreter = nullptr;
 		TfLiteTensor* input_tensor = nullptr;
 		const TfLiteTensor* output_tensor = nullptr;
+		std::string budget_owner = ""; // model path the threads are assigned to
 	};
 }
 
@@ -69,9 +69,9 @@ bool CSScript::init(struct mosquitto* mosq)
 }
 
 #ifdef __HAS_CUDA__
-bool CSScript::execute_script(const char* filename, std::list<DetectionItem*>* detections, cv::cuda::GpuMat* image)
+bool CSScript::execute_script(const char* filename, DetectionSpan detections, cv::cuda::GpuMat* image)
 #else
-bool CSScript::execute_script(const char* filename, std::list<DetectionItem*>* detections, cv::Mat* image)
+bool CSScript::execute_script(const char* filename, DetectionSpan detections, cv::Mat* image)
 #endif
 {
 	if (chai == nullptr)
@@ -87,9 +87,9 @@ bool CSScript::execute_script(const char* filename, std::list<DetectionItem*>* d
 }
 
 #ifdef __HAS_CUDA__
-bool CSScript::execute(const char* expr, std::list<cs::DetectionItem*>* detections, cv::cuda::GpuMat* image)
+bool CSScript::execute(const char* expr, DetectionSpan detections, cv::cuda::GpuMat* image)
 #else
-bool CSScript::execute(const char* expr, std::list<cs::DetectionItem*>* detections, cv::Mat* image)
+bool CSScript::execute(const char* expr, DetectionSpan detections, cv::Mat* image)
 #endif
 {
 	if (chai == nullptr)
@@ -38,21 +38,15 @@ namespace cs
 	{
 		int get_detections_count()
 		{
-			if (detections != nullptr)
-				return detections->size();
-
-			return 0;
+			return static_cast<int>(detections.size());
 		}
 
 		DetectionItem* get_detection_item(int index)
 		{
-			if (index >= detections->size())
+			if (index < 0 || index >= static_cast<int>(detections.size()))
 				return nullptr;
 
-			std::list<DetectionItem*>::iterator it = detections->begin();
-			advance(it, index);
-
-			return *it;
+			return detections[index];
 		}
 
 #ifdef __HAS_CUDA__
@@ -62,7 +56,7 @@ namespace cs
 #endif
 
 
-		std::list<DetectionItem*>* detections = nullptr;
+		DetectionSpan detections;
 #ifdef __HAS_CUDA__
 		cv::cuda::GpuMat* image = nullptr;
 #else
@@ -86,11 +80,11 @@ namespace cs
 
 		bool init(struct mosquitto* mosq);
 #ifdef __HAS_CUDA__
-		bool execute_script(const char* filename, std::list<cs::DetectionItem*>* detections, cv::cuda::GpuMat* image);
-		bool execute(const char* expr, std::list<cs::DetectionItem*>* detections, cv::cuda::GpuMat* image);
+		bool execute_script(const char* filename, DetectionSpan detections, cv::cuda::GpuMat* image);
+		bool execute(const char* expr, DetectionSpan detections, cv::cuda::GpuMat* image);
 #else
-		bool execute_script(const char* filename, std::list<cs::DetectionItem*>* detections, cv::Mat* image);
-		bool execute(const char* expr, std::list<cs::DetectionItem*>* detections, cv::Mat* image);
+		bool execute_script(const char* filename, DetectionSpan detections, cv::Mat* image);
+		bool execute(const char* expr, DetectionSpan detections, cv::Mat* image);
 #endif
 	private:
 		chaiscript::ChaiScript* chai = nullptr;
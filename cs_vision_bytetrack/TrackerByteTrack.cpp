@@ -50,7 +50,7 @@ void TrackerByteTrack::clear()
 	clear_last_detections();
 }
 
-int TrackerByteTrack::detect(cv::Mat* input, int& current_id, bool is_draw, std::list<DetectionItem*>* detections)
+int TrackerByteTrack::detect(cv::Mat* input, int& current_id, bool is_draw, DetectionSpan detections)
 {
 	if (input == nullptr || input->empty())
 	{
@@ -58,7 +58,7 @@ int TrackerByteTrack::detect(cv::Mat* input, int& current_id, bool is_draw, std:
 		return 0;
 	}
 
-	if (detections == nullptr || detections->empty())
+	if (detections.empty())
 	{
 		std::cerr << "No detections provided." << std::endl;
 		return 0;
@@ -66,7 +66,7 @@ int TrackerByteTrack::detect(cv::Mat* input, int& current_id, bool is_draw, std:
 
     clear_last_detections();
 	std::vector<DetectionItem*> input_detections;
-	for (auto& detection : *detections) {
+	for (auto& detection : detections) {
 		if (detection == nullptr)
 			continue;
 
@@ -79,7 +79,7 @@ int TrackerByteTrack::detect(cv::Mat* input, int& current_id, bool is_draw, std:
 
     for (auto i = 0; i < output_stracks.size(); i++)
     {
-        DetectionItem* item = new DetectionItem();
+        DetectionItem* item = create_detection();
         item->color = color;
 		item->id = current_id;
 		current_id++;
@@ -88,10 +88,8 @@ int TrackerByteTrack::detect(cv::Mat* input, int& current_id, bool is_draw, std:
 		item->class_id = input_detections[i]->class_id;
 		item->detector_id = id;
 
-		std::string label;
-		get_rule_label(item->class_id, label);
 		item->priority = get_rule_priority(item->class_id);
-		item->label = trim(label);
+		item->set_label(get_label(item->class_id));
 		item->score = output_stracks[i].score;
 		item->box.y = output_stracks[i].tlwh[0];
 		item->box.x = output_stracks[i].tlwh[1];
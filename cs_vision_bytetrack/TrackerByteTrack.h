@@ -34,10 +34,11 @@ namespace cs
 
 		virtual void clear();
 
-		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, std::list<DetectionItem*>* detections = nullptr) override;
+		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, DetectionSpan detections = {}) override;
 		virtual int detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw = false) override { return 0; };
 
 		virtual int detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw = false) override { return 0; };
+		virtual bool get_is_uses_detections() override { return true; };
 
 		virtual void parse(const std::string& payload, int& current_id);
 	private:
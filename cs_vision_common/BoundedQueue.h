@@ -0,0 +1,200 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <functional>
+
+namespace cs
+{
+	enum class QUEUE_DROP_POLICY
+	{
+		QUEUE_DROP_POLICY_NEWEST_WINS = 0,	// full queue discards its oldest element
+		QUEUE_DROP_POLICY_BLOCK = 1		// full queue blocks the producer
+	};
+
+	inline QUEUE_DROP_POLICY queue_drop_policy_from_string(const std::string& str, QUEUE_DROP_POLICY defval)
+	{
+		if (str == "newest" || str == "newest_wins" || str == "drop")
+			return QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_NEWEST_WINS;
+		if (str == "block")
+			return QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_BLOCK;
+
+		return defval;
+	}
+
+	/*
+	* Bounded blocking queue of owned pointers. Elements dropped by the newest-wins policy or
+	* left in the queue on destruction are disposed: deleted or given to the deleter when it is set.
+	*/
+	template<class T>
+	class BoundedQueue
+	{
+	public:
+		BoundedQueue(size_t capacity = 1, QUEUE_DROP_POLICY policy = QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_NEWEST_WINS)
+		{
+			this->capacity = capacity > 0 ? capacity : 1;
+			this->policy = policy;
+		}
+
+		virtual ~BoundedQueue()
+		{
+			clear();
+		}
+
+		bool push(T* elem)
+		{
+			if (elem == nullptr)
+				return false;
+
+			T* dropped_elem = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(m);
+				if (policy == QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_BLOCK) {
+					not_full.wait(lock, [this] { return q.size() < capacity || closed; });
+				}
+
+				if (closed) {
+					lock.unlock();
+					dispose(elem);
+					return false;
+				}
+
+				if (q.size() >= capacity) {
+					dropped_elem = q.front();
+					q.pop_front();
+					dropped++;
+				}
+
+				q.push_back(elem);
+				pushed++;
+			}
+			not_empty.notify_one();
+
+			if (dropped_elem != nullptr)
+				dispose(dropped_elem);
+
+			return true;
+		}
+
+		// returns false when the queue is closed and drained
+		bool pop(T*& elem)
+		{
+			std::unique_lock<std::mutex> lock(m);
+			not_empty.wait(lock, [this] { return !q.empty() || closed; });
+			if (q.empty())
+				return false;
+
+			elem = q.front();
+			q.pop_front();
+			lock.unlock();
+
+			not_full.notify_one();
+			return true;
+		}
+
+		T* try_pop()
+		{
+			T* elem = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(m);
+				if (!q.empty()) {
+					elem = q.front();
+					q.pop_front();
+				}
+			}
+
+			if (elem != nullptr)
+				not_full.notify_one();
+
+			return elem;
+		}
+
+		void close()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m);
+				closed = true;
+			}
+			not_empty.notify_all();
+			not_full.notify_all();
+		}
+
+		void clear()
+		{
+			std::list<T*> elems;
+			{
+				std::lock_guard<std::mutex> lock(m);
+				elems.swap(q);
+			}
+
+			for (auto elem : elems)
+				dispose(elem);
+		}
+
+		// elements are returned to their owner (e.g. an object pool) instead of being deleted
+		void set_deleter(std::function<void(T*)> func) { deleter = func; }
+
+		void dispose(T* elem)
+		{
+			if (elem == nullptr)
+				return;
+
+			if (deleter)
+				deleter(elem);
+			else
+				delete elem;
+		}
+
+		size_t size()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			return q.size();
+		}
+
+		size_t get_capacity() const { return capacity; }
+		QUEUE_DROP_POLICY get_policy() const { return policy; }
+		uint64_t get_pushed() const { return pushed; }
+		uint64_t get_dropped() const { return dropped; }
+	private:
+		std::list<T*> q;
+		size_t capacity = 1;
+		QUEUE_DROP_POLICY policy = QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_NEWEST_WINS;
+		bool closed = false;
+		std::function<void(T*)> deleter;
+
+		std::mutex m;
+		std::condition_variable not_empty;
+		std::condition_variable not_full;
+
+		std::atomic<uint64_t> pushed = 0;
+		std::atomic<uint64_t> dropped = 0;
+	};
+}
@@ -0,0 +1,164 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace cs
+{
+	/*
+	* Single slot hand-off between two threads. The producer never blocks: a newer item replaces
+	* the pending one and the replaced item is counted as dropped. The consumer sleeps on a
+	* condition variable until an item arrives or the channel is closed.
+	*/
+	template<class T>
+	class FrameChannel
+	{
+	public:
+		FrameChannel() {}
+
+		bool put(const T& item)
+		{
+			bool replaced = false;
+			{
+				std::lock_guard<std::mutex> lock(m);
+				if (closed)
+					return false;
+
+				replaced = pending;
+				slot = item;
+				pending = true;
+				put_time = std::chrono::steady_clock::now();
+			}
+			cv.notify_one();
+
+			if (replaced)
+				dropped++;
+
+			return !replaced;
+		}
+
+		bool take(T& item)
+		{
+			std::unique_lock<std::mutex> lock(m);
+			cv.wait(lock, [this] { return pending || closed; });
+
+			return take_locked(item);
+		}
+
+		bool take(T& item, std::chrono::milliseconds timeout)
+		{
+			std::unique_lock<std::mutex> lock(m);
+			if (!cv.wait_for(lock, timeout, [this] { return pending || closed; }))
+				return false;
+
+			return take_locked(item);
+		}
+
+		bool try_take(T& item)
+		{
+			std::lock_guard<std::mutex> lock(m);
+			return take_locked(item);
+		}
+
+		bool is_pending()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			return pending;
+		}
+
+		// producer decided not to offer a frame because the consumer is still busy
+		void skip() { dropped++; }
+
+		void close()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m);
+				closed = true;
+			}
+			cv.notify_all();
+		}
+
+		void open()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			closed = false;
+		}
+
+		bool is_closed()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			return closed;
+		}
+
+		uint64_t get_passed() const { return passed; }
+		uint64_t get_dropped() const { return dropped; }
+		int64_t get_wakeup_latency_us() const { return wakeup_latency_us; }
+		int64_t get_max_wakeup_latency_us() const { return max_wakeup_latency_us; }
+
+		void reset_stats()
+		{
+			passed = 0;
+			dropped = 0;
+			wakeup_latency_us = 0;
+			max_wakeup_latency_us = 0;
+		}
+	private:
+		bool take_locked(T& item)
+		{
+			if (!pending)
+				return false;
+
+			item = slot;
+			slot = T();
+			pending = false;
+			passed++;
+
+			int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - put_time).count();
+			wakeup_latency_us = latency;
+			if (latency > max_wakeup_latency_us)
+				max_wakeup_latency_us = latency;
+
+			return true;
+		}
+
+		T slot = T();
+		bool pending = false;
+		bool closed = false;
+		std::chrono::steady_clock::time_point put_time;
+
+		std::mutex m;
+		std::condition_variable cv;
+
+		std::atomic<uint64_t> passed = 0;
+		std::atomic<uint64_t> dropped = 0;
+		std::atomic<int64_t> wakeup_latency_us = 0;
+		std::atomic<int64_t> max_wakeup_latency_us = 0;
+	};
+}
@@ -0,0 +1,111 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "ModelRegistry.h"
+#include <iostream>
+#include <chrono>
+
+using namespace cs;
+
+ModelRegistry* ModelRegistry::get_instance()
+{
+	static ModelRegistry instance;
+	return &instance;
+}
+
+std::shared_ptr<void> ModelRegistry::acquire_model(const std::string& key, const std::function<std::shared_ptr<void>(size_t& bytes)>& load)
+{
+	std::shared_ptr<std::mutex> loading;
+	{
+		std::lock_guard<std::mutex> lock(m);
+		model_entry& entry = models[key];
+		if (auto model = entry.model.lock()) {
+			entry.shares++;
+			std::cout << "[ModelRegistry] " << key << " shared, users: " << entry.model.use_count() << std::endl;
+			return model;
+		}
+
+		if (entry.loading == nullptr)
+			entry.loading = std::make_shared<std::mutex>();
+		loading = entry.loading;
+	}
+
+	// one loader per key, the others wait for it and share the result
+	std::lock_guard<std::mutex> load_lock(*loading);
+	{
+		std::lock_guard<std::mutex> lock(m);
+		model_entry& entry = models[key];
+		if (auto model = entry.model.lock()) {
+			entry.shares++;
+			std::cout << "[ModelRegistry] " << key << " shared, users: " << entry.model.use_count() << std::endl;
+			return model;
+		}
+	}
+
+	size_t bytes = 0;
+	auto start = std::chrono::steady_clock::now();
+	std::shared_ptr<void> model = load(bytes);
+	double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (model == nullptr)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(m);
+	model_entry& entry = models[key];
+	entry.model = model;
+	entry.bytes = bytes;
+	entry.load_ms = load_ms;
+	entry.loads++;
+
+	std::cout << "[ModelRegistry] " << key << " loaded in " << load_ms << " ms, MB: " << bytes / (1024.0 * 1024.0) << std::endl;
+
+	return model;
+}
+
+std::vector<model_stats> ModelRegistry::get_stats()
+{
+	std::lock_guard<std::mutex> lock(m);
+
+	std::vector<model_stats> result;
+	result.reserve(models.size());
+	for (auto& [key, entry] : models) {
+		model_stats stats;
+		stats.key = key;
+		stats.bytes = entry.bytes;
+		stats.load_ms = entry.load_ms;
+		stats.users = entry.model.use_count();
+		stats.loads = entry.loads;
+		stats.shares = entry.shares;
+		result.push_back(stats);
+	}
+
+	return result;
+}
+
+void ModelRegistry::print_stats()
+{
+	for (auto& stats : get_stats()) {
+		std::cout << "[ModelRegistry] " << stats.key << " users: " << stats.users << " MB: " << stats.bytes / (1024.0 * 1024.0)
+			<< " load ms: " << stats.load_ms << " loads: " << stats.loads << " shares: " << stats.shares << std::endl;
+	}
+}
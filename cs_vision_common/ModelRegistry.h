@@ -0,0 +1,87 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+namespace cs
+{
+	class model_stats
+	{
+	public:
+		std::string key;
+		size_t bytes = 0;		// reported by the loader: mapped file, weights or engine size
+		double load_ms = 0;		// last load
+		long users = 0;			// instances holding the model now
+		uint64_t loads = 0;
+		uint64_t shares = 0;	// requests served without loading
+	};
+
+	/*
+	* Process wide registry of loaded models. A model is loaded once per key and shared read-only by every
+	* detector asking for the same key, it is released with its last user. Keys carry the backend prefix and
+	* the options the loaded object depends on (e.g. "ort:<path>:<threads>"), detectors keep their own
+	* interpreters/execution contexts on top of the shared model.
+	*/
+	class ModelRegistry
+	{
+	public:
+		static ModelRegistry* get_instance();
+
+		// load - called once while the model is in use, sets bytes. Loads of different keys run in parallel
+		template<class T>
+		std::shared_ptr<T> acquire(const std::string& key, const std::function<std::shared_ptr<T>(size_t& bytes)>& load)
+		{
+			return std::static_pointer_cast<T>(acquire_model(key, [&load](size_t& bytes) -> std::shared_ptr<void> { return load(bytes); }));
+		}
+
+		std::vector<model_stats> get_stats();
+		void print_stats();
+	private:
+		ModelRegistry() {};
+
+		class model_entry
+		{
+		public:
+			std::weak_ptr<void> model;
+			std::shared_ptr<std::mutex> loading;
+			size_t bytes = 0;
+			double load_ms = 0;
+			uint64_t loads = 0;
+			uint64_t shares = 0;
+		};
+
+		std::shared_ptr<void> acquire_model(const std::string& key, const std::function<std::shared_ptr<void>(size_t& bytes)>& load);
+
+		std::mutex m;
+		std::map<std::string, model_entry> models;
+	};
+}
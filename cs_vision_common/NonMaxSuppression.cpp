@@ -0,0 +1,203 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "NonMaxSuppression.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace cs;
+
+//******************************************************************************************
+// candidates above the score threshold, the best pre_top_k of them, by descending score
+void NonMaxSuppression::select(const float* scores, size_t count)
+{
+	order.clear();
+	for (size_t i = 0; i < count; i++) {
+		if (scores[i] >= params.score_threshold)
+			order.push_back(static_cast<int>(i));
+	}
+
+	auto by_score = [scores](int a, int b) { return scores[a] > scores[b] || (scores[a] == scores[b] && a < b); };
+	if (params.pre_top_k > 0 && order.size() > static_cast<size_t>(params.pre_top_k)) {
+		std::nth_element(order.begin(), order.begin() + params.pre_top_k, order.end(), by_score);
+		order.resize(params.pre_top_k);
+	}
+
+	std::sort(order.begin(), order.end(), by_score);
+}
+
+NonMaxSuppression::kept_boxes& NonMaxSuppression::get_group(int class_id)
+{
+	int key = params.is_class_aware ? std::max(class_id, 0) : 0;
+	if (key >= static_cast<int>(group_of_class.size()))
+		group_of_class.resize(key + 1, -1);
+
+	if (group_of_class[key] < 0) {
+		group_of_class[key] = static_cast<int>(used_groups.size());
+		used_groups.push_back(key);
+		if (groups.size() < used_groups.size())
+			groups.resize(used_groups.size());
+		groups[group_of_class[key]].clear();
+	}
+
+	return groups[group_of_class[key]];
+}
+
+void NonMaxSuppression::run(const float* x, const float* y, const float* w, const float* h, float* scores, const int* class_ids, size_t count, std::vector<int>& keep)
+{
+	keep.clear();
+	if (count == 0)
+		return;
+
+	select(scores, count);
+
+	if (params.method == NMS_METHOD::NMS_METHOD_SOFT_LINEAR || params.method == NMS_METHOD::NMS_METHOD_SOFT_GAUSSIAN)
+		run_soft(x, y, w, h, scores, class_ids, keep);
+	else
+		run_hard(x, y, w, h, class_ids, keep);
+
+	for (int key : used_groups) {
+		group_of_class[key] = -1;
+	}
+	used_groups.clear();
+}
+
+void NonMaxSuppression::run_hard(const float* x, const float* y, const float* w, const float* h, const int* class_ids, std::vector<int>& keep)
+{
+	const float threshold = params.iou_threshold;
+	const bool is_diou = params.method == NMS_METHOD::NMS_METHOD_DIOU;
+
+	for (int i : order) {
+		const float bx1 = x[i];
+		const float by1 = y[i];
+		const float bx2 = x[i] + w[i];
+		const float by2 = y[i] + h[i];
+		const float barea = w[i] * h[i];
+
+		kept_boxes& kept = get_group(class_ids[i]);
+		const size_t n = kept.area.size();
+		const float* kx1 = kept.x1.data();
+		const float* ky1 = kept.y1.data();
+		const float* kx2 = kept.x2.data();
+		const float* ky2 = kept.y2.data();
+		const float* karea = kept.area.data();
+
+		int is_suppressed = 0;
+		if (!is_diou) {
+			// inter / union > threshold without the division
+			for (size_t k = 0; k < n; k++) {
+				float iw = std::min(bx2, kx2[k]) - std::max(bx1, kx1[k]);
+				float ih = std::min(by2, ky2[k]) - std::max(by1, ky1[k]);
+				iw = iw > 0 ? iw : 0;
+				ih = ih > 0 ? ih : 0;
+				float inter = iw * ih;
+				is_suppressed |= inter > threshold * (barea + karea[k] - inter);
+			}
+		}
+		else {
+			const float bcx = bx1 + bx2;
+			const float bcy = by1 + by2;
+			for (size_t k = 0; k < n; k++) {
+				float iw = std::min(bx2, kx2[k]) - std::max(bx1, kx1[k]);
+				float ih = std::min(by2, ky2[k]) - std::max(by1, ky1[k]);
+				iw = iw > 0 ? iw : 0;
+				ih = ih > 0 ? ih : 0;
+				float inter = iw * ih;
+				float iou = inter / (barea + karea[k] - inter + 1e-9f);
+
+				// squared distance of the centers over the squared diagonal of the enclosing box
+				float dx = (bcx - kx1[k] - kx2[k]) * 0.5f;
+				float dy = (bcy - ky1[k] - ky2[k]) * 0.5f;
+				float cw = std::max(bx2, kx2[k]) - std::min(bx1, kx1[k]);
+				float ch = std::max(by2, ky2[k]) - std::min(by1, ky1[k]);
+				float penalty = (dx * dx + dy * dy) / (cw * cw + ch * ch + 1e-9f);
+				is_suppressed |= iou - penalty > threshold;
+			}
+		}
+
+		if (is_suppressed)
+			continue;
+
+		kept.add(bx1, by1, bx2, by2);
+		keep.push_back(i);
+		if (params.max_detections > 0 && keep.size() >= static_cast<size_t>(params.max_detections))
+			break;
+	}
+}
+
+// candidates overlapping a kept box lose score, they are dropped under score_threshold
+void NonMaxSuppression::run_soft(const float* x, const float* y, const float* w, const float* h, float* scores, const int* class_ids, std::vector<int>& keep)
+{
+	const bool is_gaussian = params.method == NMS_METHOD::NMS_METHOD_SOFT_GAUSSIAN;
+	const float sigma = params.soft_sigma > 0 ? params.soft_sigma : 0.5f;
+
+	std::vector<int>& active = order;
+	while (!active.empty()) {
+		size_t best = 0;
+		for (size_t k = 1; k < active.size(); k++) {
+			if (scores[active[k]] > scores[active[best]])
+				best = k;
+		}
+
+		int i = active[best];
+		active[best] = active.back();
+		active.pop_back();
+
+		keep.push_back(i);
+		if (params.max_detections > 0 && keep.size() >= static_cast<size_t>(params.max_detections))
+			break;
+
+		const float bx1 = x[i];
+		const float by1 = y[i];
+		const float bx2 = x[i] + w[i];
+		const float by2 = y[i] + h[i];
+		const float barea = w[i] * h[i];
+
+		size_t k = 0;
+		while (k < active.size()) {
+			int j = active[k];
+			if (params.is_class_aware && class_ids[j] != class_ids[i]) {
+				k++;
+				continue;
+			}
+
+			float iw = std::max(0.0f, std::min(bx2, x[j] + w[j]) - std::max(bx1, x[j]));
+			float ih = std::max(0.0f, std::min(by2, y[j] + h[j]) - std::max(by1, y[j]));
+			float inter = iw * ih;
+			float iou = inter / (barea + w[j] * h[j] - inter + 1e-9f);
+
+			if (is_gaussian)
+				scores[j] *= std::exp(-(iou * iou) / sigma);
+			else if (iou > params.iou_threshold)
+				scores[j] *= 1.0f - iou;
+
+			if (scores[j] < params.score_threshold) {
+				active[k] = active.back();
+				active.pop_back();
+			}
+			else
+				k++;
+		}
+	}
+}
@@ -0,0 +1,104 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "YoloDecoder.h"
+
+namespace cs
+{
+	enum class NMS_METHOD
+	{
+		NMS_METHOD_GREEDY = 0,
+		NMS_METHOD_DIOU = 1,			// IoU minus the normalized distance of the centers, close neighbours survive
+		NMS_METHOD_SOFT_LINEAR = 2,		// overlapping boxes lose score instead of being removed
+		NMS_METHOD_SOFT_GAUSSIAN = 3
+	};
+
+	class nms_params
+	{
+	public:
+		float iou_threshold = 0.45f;
+		float score_threshold = 0.25f;
+		int pre_top_k = 0;			// best candidates taken into the suppression, 0 - all
+		int max_detections = 0;		// 0 - all
+		bool is_class_aware = true;	// false - boxes of different classes suppress each other
+		NMS_METHOD method = NMS_METHOD::NMS_METHOD_GREEDY;
+		float soft_sigma = 0.5f;	// gaussian Soft-NMS
+	};
+
+	/*
+	* Non maximum suppression over structure of arrays boxes (top left corner and size). Every class is suppressed
+	* separately in one call: a candidate is compared only with the kept boxes of its class, the comparison is a
+	* branchless loop over the kept boxes` coordinates the compilers vectorize. Buffers are reused between calls.
+	*/
+	class NonMaxSuppression
+	{
+	public:
+		NonMaxSuppression() {};
+		NonMaxSuppression(const nms_params& params) : params(params) {};
+		virtual ~NonMaxSuppression() {};
+
+		void set_params(const nms_params& params) { this->params = params; };
+		const nms_params& get_params() const { return params; };
+
+		// keep - indices of the kept boxes by descending score. Soft-NMS writes the decayed scores back to scores
+		void run(const float* x, const float* y, const float* w, const float* h, float* scores, const int* class_ids, size_t count, std::vector<int>& keep);
+		void run(yolo_candidates& candidates, std::vector<int>& keep)
+		{
+			run(candidates.x.data(), candidates.y.data(), candidates.w.data(), candidates.h.data(), candidates.scores.data(), candidates.class_ids.data(), candidates.size(), keep);
+		}
+	private:
+		// kept boxes of one class
+		class kept_boxes
+		{
+		public:
+			std::vector<float> x1, y1, x2, y2, area;
+
+			void clear() { x1.clear(); y1.clear(); x2.clear(); y2.clear(); area.clear(); };
+			void add(float bx1, float by1, float bx2, float by2)
+			{
+				x1.push_back(bx1);
+				y1.push_back(by1);
+				x2.push_back(bx2);
+				y2.push_back(by2);
+				area.push_back((bx2 - bx1) * (by2 - by1));
+			}
+		};
+
+		nms_params params;
+
+		std::vector<int> order;
+		std::vector<kept_boxes> groups;
+		std::vector<int> group_of_class;
+		std::vector<int> used_groups;
+
+		void select(const float* scores, size_t count);
+		kept_boxes& get_group(int class_id);
+		void run_hard(const float* x, const float* y, const float* w, const float* h, const int* class_ids, std::vector<int>& keep);
+		void run_soft(const float* x, const float* y, const float* w, const float* h, float* scores, const int* class_ids, std::vector<int>& keep);
+	};
+}
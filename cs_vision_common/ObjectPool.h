@@ -0,0 +1,92 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+
+namespace cs
+{
+	/*
+	* Free list of reusable objects. get() returns a free object or a new one, put() calls reset()
+	* and keeps the object for the next get() while there are less than max_free of them.
+	*/
+	template<class T>
+	class ObjectPool
+	{
+	public:
+		ObjectPool(size_t max_free = 16) : max_free(max_free) {}
+
+		virtual ~ObjectPool()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			for (auto item : free_items)
+				delete item;
+			free_items.clear();
+		}
+
+		T* get()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m);
+				if (!free_items.empty()) {
+					T* item = free_items.back();
+					free_items.pop_back();
+					return item;
+				}
+			}
+
+			return new T();
+		}
+
+		void put(T* item)
+		{
+			if (item == nullptr)
+				return;
+
+			item->reset();
+
+			{
+				std::lock_guard<std::mutex> lock(m);
+				if (free_items.size() < max_free) {
+					free_items.push_back(item);
+					return;
+				}
+			}
+
+			delete item;
+		}
+
+		size_t get_free_count()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			return free_items.size();
+		}
+	private:
+		std::vector<T*> free_items;
+		size_t max_free = 16;
+		std::mutex m;
+	};
+}
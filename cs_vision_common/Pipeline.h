@@ -0,0 +1,178 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include "BoundedQueue.h"
+
+namespace cs
+{
+	/*
+	* One worker thread of a Pipeline. It pops an item from its input queue, runs the stage
+	* function and forwards the item to the next stage. The function returns false to stop
+	* the item from going further.
+	*/
+	template<class T>
+	class PipelineStage
+	{
+	public:
+		PipelineStage(const std::string& name, std::function<bool(T*)> func, size_t queue_size, QUEUE_DROP_POLICY policy)
+			: name(name), func(func), queue(queue_size, policy)
+		{
+		}
+
+		std::string name = "";
+		std::function<bool(T*)> func;
+		BoundedQueue<T> queue;
+		PipelineStage<T>* next = nullptr;
+
+		uint64_t get_processed() const { return processed; }
+		uint64_t get_dropped() const { return queue.get_dropped(); }
+		int64_t get_last_duration_us() const { return last_duration_us; }
+		int64_t get_mean_duration_us() const { return processed > 0 ? total_duration_us / (int64_t)processed : 0; }
+
+		void run()
+		{
+			T* item = nullptr;
+
+			while (queue.pop(item)) {
+				auto begin = std::chrono::steady_clock::now();
+				bool is_forward = func(item);
+				last_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+				total_duration_us += last_duration_us;
+				processed++;
+
+				if (is_forward && next != nullptr)
+					next->queue.push(item);
+				else
+					queue.dispose(item);
+			}
+		}
+
+		std::thread worker;
+	private:
+		std::atomic<uint64_t> processed = 0;
+		std::atomic<int64_t> last_duration_us = 0;
+		std::atomic<int64_t> total_duration_us = 0;
+	};
+
+	/*
+	* Linear chain of stages connected by bounded queues, one thread per stage. While one stage
+	* works on frame N the previous one can already work on frame N+1, so throughput follows
+	* the slowest stage instead of the sum of all of them.
+	*/
+	template<class T>
+	class Pipeline
+	{
+	public:
+		Pipeline() {}
+
+		virtual ~Pipeline()
+		{
+			stop();
+
+			for (auto stage : stages)
+				delete stage;
+			stages.clear();
+		}
+
+		void add_stage(const std::string& name, std::function<bool(T*)> func, size_t queue_size = 1, QUEUE_DROP_POLICY policy = QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_NEWEST_WINS)
+		{
+			if (is_started)
+				return;
+
+			PipelineStage<T>* stage = new PipelineStage<T>(name, func, queue_size, policy);
+			stage->queue.set_deleter(deleter);
+			if (!stages.empty())
+				stages.back()->next = stage;
+
+			stages.push_back(stage);
+		}
+
+		bool start()
+		{
+			if (is_started || stages.empty())
+				return false;
+
+			for (auto stage : stages)
+				stage->worker = std::thread(&PipelineStage<T>::run, stage);
+
+			is_started = true;
+			return true;
+		}
+
+		// closes the stages front to back so every item already accepted is drained
+		void stop()
+		{
+			if (!is_started)
+				return;
+
+			for (auto stage : stages) {
+				stage->queue.close();
+				if (stage->worker.joinable())
+					stage->worker.join();
+			}
+
+			is_started = false;
+		}
+
+		// items leaving the pipeline are given to func instead of being deleted
+		void set_deleter(std::function<void(T*)> func)
+		{
+			if (is_started)
+				return;
+
+			deleter = func;
+			for (auto stage : stages)
+				stage->queue.set_deleter(deleter);
+		}
+
+		bool push(T* item)
+		{
+			if (stages.empty()) {
+				if (deleter)
+					deleter(item);
+				else
+					delete item;
+				return false;
+			}
+
+			return stages.front()->queue.push(item);
+		}
+
+		bool get_is_started() const { return is_started; }
+		const std::vector<PipelineStage<T>*>& get_stages() const { return stages; }
+	private:
+		std::vector<PipelineStage<T>*> stages;
+		std::function<void(T*)> deleter;
+		bool is_started = false;
+	};
+}
@@ -0,0 +1,300 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "TensorPacker.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace cs;
+
+namespace
+{
+	template<class T>
+	inline T to_tensor(float value);
+
+	template<>
+	inline float to_tensor<float>(float value)
+	{
+		return value;
+	}
+
+	template<>
+	inline uint8_t to_tensor<uint8_t>(float value)
+	{
+		int v = static_cast<int>(lrintf(value));
+		return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+	}
+
+	template<>
+	inline int8_t to_tensor<int8_t>(float value)
+	{
+		int v = static_cast<int>(lrintf(value));
+		return static_cast<int8_t>(v < -128 ? -128 : (v > 127 ? 127 : v));
+	}
+}
+
+void TensorPacker::set_params(const tensor_pack_params& params)
+{
+	this->params = params;
+
+	bool is_quantized = params.type != TENSOR_TYPE::TENSOR_TYPE_FLOAT32;
+	float qs = params.quant_scale != 0 ? params.quant_scale : 1.0f;
+	for (int c = 0; c < 3; c++) {
+		float stddev = params.stddev[c] != 0 ? params.stddev[c] : 1.0f;
+		alpha[c] = 1.0f / (255.0f * stddev);
+		beta[c] = -params.mean[c] / stddev;
+		if (is_quantized) {
+			alpha[c] /= qs;
+			beta[c] = beta[c] / qs + params.zero_point;
+		}
+		pad[c] = params.pad_value * alpha[c] + beta[c];
+	}
+
+	// geometry depends on the tensor size, rebuilt on the next pack
+	src_width = 0;
+	src_height = 0;
+	src_channels = 0;
+}
+
+void TensorPacker::prepare(int width, int height, int channels)
+{
+	if (width == src_width && height == src_height && channels == src_channels)
+		return;
+
+	src_width = width;
+	src_height = height;
+	src_channels = channels;
+
+	int rw = params.width;
+	int rh = params.height;
+	if (params.resize != TENSOR_RESIZE::TENSOR_RESIZE_STRETCH) {
+		float scale = min(static_cast<float>(params.width) / width, static_cast<float>(params.height) / height);
+		rw = min(max(static_cast<int>(lrintf(width * scale)), 1), params.width);
+		rh = min(max(static_cast<int>(lrintf(height * scale)), 1), params.height);
+	}
+
+	geometry.resized_width = rw;
+	geometry.resized_height = rh;
+	geometry.scale_x = static_cast<float>(rw) / width;
+	geometry.scale_y = static_cast<float>(rh) / height;
+	geometry.pad_x = 0;
+	geometry.pad_y = 0;
+	if (params.resize == TENSOR_RESIZE::TENSOR_RESIZE_LETTERBOX_CENTER) {
+		geometry.pad_x = (params.width - rw) / 2;
+		geometry.pad_y = (params.height - rh) / 2;
+	}
+	inv_scale_y = static_cast<float>(height) / rh;
+
+	// half pixel centers, as cv::resize with INTER_LINEAR
+	float inv_scale_x = static_cast<float>(width) / rw;
+	x_offsets0.resize(rw);
+	x_offsets1.resize(rw);
+	x_alpha.resize(rw);
+	for (int x = 0; x < rw; x++) {
+		float sx = (x + 0.5f) * inv_scale_x - 0.5f;
+		int x0 = static_cast<int>(floorf(sx));
+		float a = sx - x0;
+		if (x0 < 0) {
+			x0 = 0;
+			a = 0;
+		}
+		if (x0 >= width - 1) {
+			x0 = width - 1;
+			a = 0;
+		}
+		x_offsets0[x] = x0 * channels;
+		x_offsets1[x] = min(x0 + 1, width - 1) * channels;
+		x_alpha[x] = a;
+	}
+
+	for (auto& row : rows)
+		row.resize(static_cast<size_t>(rw) * 3);
+	blended.resize(static_cast<size_t>(rw) * 3);
+	row_index[0] = -1;
+	row_index[1] = -1;
+}
+
+const float* TensorPacker::get_row(const uint8_t* src, size_t step, int y, int keep_slot, int& slot)
+{
+	for (int i = 0; i < 2; i++) {
+		if (row_index[i] == y) {
+			slot = i;
+			return rows[i].data();
+		}
+	}
+
+	slot = keep_slot == 0 ? 1 : 0;
+	row_index[slot] = y;
+
+	const uint8_t* s = src + static_cast<size_t>(y) * step;
+	float* __restrict out = rows[slot].data();
+	const int* __restrict o0 = x_offsets0.data();
+	const int* __restrict o1 = x_offsets1.data();
+	const float* __restrict xa = x_alpha.data();
+	int rw = geometry.resized_width;
+	for (int x = 0; x < rw; x++) {
+		const uint8_t* p0 = s + o0[x];
+		const uint8_t* p1 = s + o1[x];
+		float a = xa[x];
+		out[0] = p0[0] + (p1[0] - p0[0]) * a;
+		out[1] = p0[1] + (p1[1] - p0[1]) * a;
+		out[2] = p0[2] + (p1[2] - p0[2]) * a;
+		out += 3;
+	}
+
+	return rows[slot].data();
+}
+
+template<class T>
+void TensorPacker::pack_rows(const uint8_t* src, size_t step, T* dst)
+{
+	const int w = params.width;
+	const int h = params.height;
+	const int rw = geometry.resized_width;
+	const int rh = geometry.resized_height;
+	const int px = geometry.pad_x;
+	const int py = geometry.pad_y;
+	const size_t plane = static_cast<size_t>(w) * h;
+	const bool is_nchw = params.layout == TENSOR_LAYOUT::TENSOR_LAYOUT_NCHW;
+
+	int source_channel[3] = { 0, 1, 2 };
+	if (params.is_swap_rb) {
+		source_channel[0] = 2;
+		source_channel[2] = 0;
+	}
+
+	T pad_value[3] = { to_tensor<T>(pad[0]), to_tensor<T>(pad[1]), to_tensor<T>(pad[2]) };
+
+	for (int y = 0; y < h; y++) {
+		int ry = y - py;
+		bool is_pad_row = ry < 0 || ry >= rh;
+
+		const float* row = nullptr;
+		if (!is_pad_row) {
+			float sy = (ry + 0.5f) * inv_scale_y - 0.5f;
+			int y0 = static_cast<int>(floorf(sy));
+			float fy = sy - y0;
+			if (y0 < 0) {
+				y0 = 0;
+				fy = 0;
+			}
+			if (y0 >= src_height - 1) {
+				y0 = src_height - 1;
+				fy = 0;
+			}
+
+			int slot0 = 0, slot1 = 0;
+			const float* r0 = get_row(src, step, y0, -1, slot0);
+			if (fy == 0) {
+				row = r0;
+			}
+			else {
+				const float* r1 = get_row(src, step, y0 + 1, slot0, slot1);
+				float* __restrict b = blended.data();
+				const int n = rw * 3;
+				for (int i = 0; i < n; i++)
+					b[i] = r0[i] + (r1[i] - r0[i]) * fy;
+				row = b;
+			}
+		}
+
+		if (is_nchw) {
+			for (int c = 0; c < 3; c++) {
+				T* __restrict out = dst + c * plane + static_cast<size_t>(y) * w;
+				if (is_pad_row) {
+					std::fill(out, out + w, pad_value[c]);
+					continue;
+				}
+
+				std::fill(out, out + px, pad_value[c]);
+				const float* __restrict in = row + source_channel[c];
+				const float a = alpha[c];
+				const float b = beta[c];
+				T* __restrict o = out + px;
+				for (int x = 0; x < rw; x++)
+					o[x] = to_tensor<T>(in[x * 3] * a + b);
+				std::fill(out + px + rw, out + w, pad_value[c]);
+			}
+		}
+		else {
+			T* __restrict out = dst + static_cast<size_t>(y) * w * 3;
+			int x = 0;
+			for (; x < (is_pad_row ? w : px); x++) {
+				out[x * 3] = pad_value[0];
+				out[x * 3 + 1] = pad_value[1];
+				out[x * 3 + 2] = pad_value[2];
+			}
+			if (is_pad_row)
+				continue;
+
+			const float a0 = alpha[0], a1 = alpha[1], a2 = alpha[2];
+			const float b0 = beta[0], b1 = beta[1], b2 = beta[2];
+			const int c0 = source_channel[0], c1 = source_channel[1], c2 = source_channel[2];
+			T* __restrict o = out + static_cast<size_t>(px) * 3;
+			for (int i = 0; i < rw; i++) {
+				const float* p = row + i * 3;
+				o[i * 3] = to_tensor<T>(p[c0] * a0 + b0);
+				o[i * 3 + 1] = to_tensor<T>(p[c1] * a1 + b1);
+				o[i * 3 + 2] = to_tensor<T>(p[c2] * a2 + b2);
+			}
+			for (x = px + rw; x < w; x++) {
+				out[x * 3] = pad_value[0];
+				out[x * 3 + 1] = pad_value[1];
+				out[x * 3 + 2] = pad_value[2];
+			}
+		}
+	}
+}
+
+bool TensorPacker::pack(const uint8_t* src, size_t step, int width, int height, int channels, void* dst, tensor_pack_info* info)
+{
+	if (src == nullptr || dst == nullptr || width <= 0 || height <= 0 || params.width <= 0 || params.height <= 0)
+		return false;
+
+	if (channels != 3 && channels != 4)
+		return false;
+
+	prepare(width, height, channels);
+	// rows are cached by index only within one frame
+	row_index[0] = -1;
+	row_index[1] = -1;
+
+	switch (params.type) {
+	case TENSOR_TYPE::TENSOR_TYPE_UINT8:
+		pack_rows(src, step, static_cast<uint8_t*>(dst));
+		break;
+	case TENSOR_TYPE::TENSOR_TYPE_INT8:
+		pack_rows(src, step, static_cast<int8_t*>(dst));
+		break;
+	default:
+		pack_rows(src, step, static_cast<float*>(dst));
+		break;
+	}
+
+	if (info != nullptr)
+		*info = geometry;
+
+	return true;
+}
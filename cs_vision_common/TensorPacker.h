@@ -0,0 +1,130 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace cs
+{
+	enum class TENSOR_LAYOUT
+	{
+		TENSOR_LAYOUT_NCHW = 0,
+		TENSOR_LAYOUT_NHWC = 1
+	};
+
+	enum class TENSOR_TYPE
+	{
+		TENSOR_TYPE_FLOAT32 = 0,
+		TENSOR_TYPE_UINT8 = 1,
+		TENSOR_TYPE_INT8 = 2
+	};
+
+	enum class TENSOR_RESIZE
+	{
+		TENSOR_RESIZE_STRETCH = 0,
+		TENSOR_RESIZE_LETTERBOX_CENTER = 1,	// aspect ratio is kept, padding on both sides
+		TENSOR_RESIZE_LETTERBOX_TOP_LEFT = 2	// aspect ratio is kept, padding on the right and bottom
+	};
+
+	class tensor_pack_params
+	{
+	public:
+		int width = 0;
+		int height = 0;
+		TENSOR_LAYOUT layout = TENSOR_LAYOUT::TENSOR_LAYOUT_NCHW;
+		TENSOR_TYPE type = TENSOR_TYPE::TENSOR_TYPE_FLOAT32;
+		TENSOR_RESIZE resize = TENSOR_RESIZE::TENSOR_RESIZE_STRETCH;
+		bool is_swap_rb = true;		// BGR frames -> RGB tensor
+		uint8_t pad_value = 0;
+
+		// value = (pixel / 255 - mean) / stddev, per tensor channel
+		float mean[3] = { 0, 0, 0 };
+		float stddev[3] = { 1, 1, 1 };
+
+		// 8 bit tensors: q = value / quant_scale + zero_point
+		float quant_scale = 1.0f / 255.0f;
+		int zero_point = 0;
+	};
+
+	// where the frame landed in the tensor: tensor = frame * scale + pad
+	class tensor_pack_info
+	{
+	public:
+		float scale_x = 1;
+		float scale_y = 1;
+		int pad_x = 0;
+		int pad_y = 0;
+		int resized_width = 0;
+		int resized_height = 0;
+	};
+
+	/*
+	* Single pass input packer of the CPU detectors: bilinear resize, letterbox, BGR->RGB, normalization and
+	* quantization are written straight into the model input tensor (NCHW or NHWC, float or 8 bit).
+	* Only two horizontally resized source rows are kept, lookup tables and rows are reused while the frame
+	* size doesn`t change, so steady state frames don`t allocate. Inner loops are contiguous float loops
+	* the compilers vectorize.
+	*/
+	class TensorPacker
+	{
+	public:
+		TensorPacker() {};
+		TensorPacker(const tensor_pack_params& params) { set_params(params); };
+		virtual ~TensorPacker() {};
+
+		void set_params(const tensor_pack_params& params);
+		const tensor_pack_params& get_params() const { return params; };
+		size_t get_tensor_elements() const { return static_cast<size_t>(params.width) * params.height * 3; };
+
+		// src - 8 bit interleaved BGR (3 channels) or BGRA (4 channels), dst - get_tensor_elements() items of params.type
+		bool pack(const uint8_t* src, size_t step, int width, int height, int channels, void* dst, tensor_pack_info* info = nullptr);
+	private:
+		tensor_pack_params params;
+		float alpha[3] = { 1, 1, 1 };	// tensor value = pixel * alpha + beta
+		float beta[3] = { 0, 0, 0 };
+		float pad[3] = { 0, 0, 0 };
+
+		int src_width = 0;
+		int src_height = 0;
+		int src_channels = 0;
+		tensor_pack_info geometry;
+		float inv_scale_y = 1;
+
+		std::vector<int> x_offsets0;
+		std::vector<int> x_offsets1;
+		std::vector<float> x_alpha;
+		std::vector<float> rows[2];
+		int row_index[2] = { -1, -1 };
+		std::vector<float> blended;
+
+		void prepare(int width, int height, int channels);
+		const float* get_row(const uint8_t* src, size_t step, int y, int keep_slot, int& slot);
+
+		template<class T>
+		void pack_rows(const uint8_t* src, size_t step, T* dst);
+	};
+}
@@ -0,0 +1,136 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "ThreadBudget.h"
+#include <iostream>
+#include <thread>
+#include <algorithm>
+
+using namespace cs;
+
+ThreadBudget* ThreadBudget::get_instance()
+{
+	static ThreadBudget instance;
+	return &instance;
+}
+
+ThreadBudget::ThreadBudget()
+{
+	init(0, 0, 0);
+}
+
+void ThreadBudget::init(int cores, int workers, int detectors)
+{
+	std::lock_guard<std::mutex> lock(m);
+
+	int hardware = static_cast<int>(std::thread::hardware_concurrency());
+	this->cores = cores > 0 ? cores : std::max(hardware, 1);
+	this->workers = workers > 0 ? workers : this->cores;
+	expected_detectors = std::max(detectors, 0);
+}
+
+// detectors registered over the expected count (settings changed at runtime) shrink the share
+int ThreadBudget::compute_share()
+{
+	int concurrent = std::min(std::max(std::max(expected_detectors, registered_detectors), 1), workers);
+	return std::max(cores / concurrent, 1);
+}
+
+int ThreadBudget::assign(const std::string& owner, const std::string& backend, int requested)
+{
+	std::lock_guard<std::mutex> lock(m);
+
+	registered_detectors++;
+	int threads = requested > 0 ? requested : compute_share();
+
+	thread_assignment& item = assignments[backend + ":" + owner];
+	item.owner = owner;
+	item.backend = backend;
+	item.requested = requested;
+	item.threads = threads;
+	item.instances++;
+
+	std::cout << "[ThreadBudget] " << backend << " " << owner << " threads: " << threads << (requested > 0 ? " (settings)" : "") << std::endl;
+
+	return threads;
+}
+
+int ThreadBudget::assign_per_worker(const std::string& owner, const std::string& backend)
+{
+	std::lock_guard<std::mutex> lock(m);
+
+	thread_assignment& item = assignments[backend + ":" + owner];
+	item.owner = owner;
+	item.backend = backend;
+	item.threads = std::max(cores / workers, 1);
+	item.instances = 1;
+
+	std::cout << "[ThreadBudget] " << backend << " " << owner << " threads: " << item.threads << std::endl;
+
+	return item.threads;
+}
+
+void ThreadBudget::release(const std::string& owner, const std::string& backend)
+{
+	std::lock_guard<std::mutex> lock(m);
+
+	auto it = assignments.find(backend + ":" + owner);
+	if (it == assignments.end())
+		return;
+
+	registered_detectors = std::max(registered_detectors - 1, 0);
+	if (--it->second.instances <= 0)
+		assignments.erase(it);
+}
+
+int ThreadBudget::get_share()
+{
+	std::lock_guard<std::mutex> lock(m);
+	return compute_share();
+}
+
+std::vector<thread_assignment> ThreadBudget::get_assignments()
+{
+	std::lock_guard<std::mutex> lock(m);
+
+	std::vector<thread_assignment> result;
+	result.reserve(assignments.size());
+	for (auto& [key, item] : assignments) {
+		result.push_back(item);
+	}
+
+	return result;
+}
+
+void ThreadBudget::print_stats()
+{
+	int total = 0;
+	auto items = get_assignments();
+	for (auto& item : items) {
+		std::cout << "[ThreadBudget] " << item.backend << " " << item.owner << " threads: " << item.threads << " instances: " << item.instances << std::endl;
+		total += item.threads * item.instances;
+	}
+
+	std::cout << "[ThreadBudget] cores: " << get_cores() << " share: " << get_share() << " assigned: " << total << std::endl;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+namespace cs
+{
+	class thread_assignment
+	{
+	public:
+		std::string owner;		// model path or component name
+		std::string backend;	// tflite, ort, opencv...
+		int requested = 0;		// set by the settings, 0 - by the budget
+		int threads = 0;
+		int instances = 0;
+	};
+
+	/*
+	* Process wide budget of the backends` intra-op threads. The inference pool already runs up to
+	* workers detectors at once, so every backend gets about cores / min(workers, detectors) threads and the
+	* runnable threads stay close to the core count. Threads set explicitly by the settings are kept as is.
+	*/
+	class ThreadBudget
+	{
+	public:
+		static ThreadBudget* get_instance();
+
+		// cores - 0 for the hardware concurrency, workers - inference pool size, detectors - expected backend instances
+		void init(int cores, int workers, int detectors);
+
+		int assign(const std::string& owner, const std::string& backend, int requested = 0);
+		// components called by every pool worker (OpenCV), cores / workers, not counted as detectors
+		int assign_per_worker(const std::string& owner, const std::string& backend);
+		void release(const std::string& owner, const std::string& backend);
+
+		int get_cores() const { return cores; };
+		int get_share();
+		std::vector<thread_assignment> get_assignments();
+		void print_stats();
+	private:
+		ThreadBudget();
+
+		int compute_share();
+
+		std::mutex m;
+		int cores = 1;
+		int workers = 1;
+		int expected_detectors = 0;
+		int registered_detectors = 0;
+		std::map<std::string, thread_assignment> assignments;
+	};
+}
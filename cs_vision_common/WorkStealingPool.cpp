@@ -0,0 +1,207 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "WorkStealingPool.h"
+#include <iostream>
+
+using namespace std;
+using namespace cs;
+
+thread_local int WorkStealingPool::worker_index = -1;
+
+WorkStealingPool* WorkStealingPool::get_instance()
+{
+	static WorkStealingPool instance;
+	return &instance;
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	shutdown();
+}
+
+bool WorkStealingPool::init(int max_workers)
+{
+	lock_guard<mutex> lock(init_mutex);
+
+	if (!workers.empty())
+		return true;
+
+	int cores = static_cast<int>(thread::hardware_concurrency());
+	if (cores <= 0)
+		cores = 1;
+
+	int count = max_workers > 0 ? max_workers : cores;
+
+	{
+		lock_guard<mutex> sleep_lock(sleep_mutex);
+		is_stopping = false;
+	}
+
+	for (int i = 0; i < count; i++)
+		workers.push_back(new pool_worker());
+
+	for (int i = 0; i < count; i++)
+		workers[i]->thread = std::thread(&WorkStealingPool::worker_loop, this, i);
+
+	cout << "[WorkStealingPool] Workers: " << count << " of " << cores << " cores" << endl;
+
+	return true;
+}
+
+void WorkStealingPool::shutdown()
+{
+	lock_guard<mutex> lock(init_mutex);
+
+	{
+		lock_guard<mutex> sleep_lock(sleep_mutex);
+		is_stopping = true;
+	}
+	sleep_cv.notify_all();
+
+	for (auto worker : workers) {
+		if (worker->thread.joinable())
+			worker->thread.join();
+		delete worker;
+	}
+	workers.clear();
+}
+
+bool WorkStealingPool::is_worker_thread() const
+{
+	return worker_index >= 0;
+}
+
+void WorkStealingPool::submit(std::function<void()> job, JobGroup* group)
+{
+	if (group != nullptr)
+		group->add();
+
+	if (workers.empty()) {
+		// pool is not started, keep the old behaviour of running on the caller`s thread
+		pool_job inline_job{ job, group };
+		execute(inline_job);
+		return;
+	}
+
+	int index = worker_index;
+	if (index < 0)
+		index = static_cast<int>(next_worker++ % workers.size());
+
+	{
+		lock_guard<mutex> lock(workers[index]->m);
+		workers[index]->jobs.push_back(pool_job{ job, group });
+	}
+
+	queued++;
+	{
+		lock_guard<mutex> lock(sleep_mutex);
+	}
+	sleep_cv.notify_one();
+}
+
+void WorkStealingPool::wait(JobGroup& group)
+{
+	if (!is_worker_thread()) {
+		group.wait();
+		return;
+	}
+
+	while (!group.is_done()) {
+		pool_job job;
+		if (try_get_job(worker_index, job))
+			execute(job);
+		else
+			group.wait_for(chrono::microseconds(200));
+	}
+}
+
+bool WorkStealingPool::try_get_job(int index, pool_job& job)
+{
+	int count = static_cast<int>(workers.size());
+
+	{
+		pool_worker* own = workers[index];
+		lock_guard<mutex> lock(own->m);
+		if (!own->jobs.empty()) {
+			job = std::move(own->jobs.back());
+			own->jobs.pop_back();
+			queued--;
+			return true;
+		}
+	}
+
+	for (int i = 1; i < count; i++) {
+		pool_worker* victim = workers[(index + i) % count];
+		lock_guard<mutex> lock(victim->m);
+		if (!victim->jobs.empty()) {
+			job = std::move(victim->jobs.front());
+			victim->jobs.pop_front();
+			queued--;
+			stolen++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingPool::execute(pool_job& job)
+{
+	try {
+		if (job.func)
+			job.func();
+	}
+	catch (const std::exception& e) {
+		cerr << "[WorkStealingPool] Job failed: " << e.what() << endl;
+	}
+	catch (...) {
+		cerr << "[WorkStealingPool] Job failed" << endl;
+	}
+
+	executed++;
+
+	if (job.group != nullptr)
+		job.group->done();
+}
+
+void WorkStealingPool::worker_loop(int index)
+{
+	worker_index = index;
+
+	for (;;) {
+		pool_job job;
+		if (try_get_job(index, job)) {
+			execute(job);
+			continue;
+		}
+
+		unique_lock<mutex> lock(sleep_mutex);
+		sleep_cv.wait(lock, [this] { return is_stopping || queued > 0; });
+		if (is_stopping && queued <= 0)
+			break;
+	}
+
+	worker_index = -1;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace cs
+{
+	/*
+	* Counter of the jobs of a group. The counter is changed and read under the mutex only, so a waiter
+	* can`t see zero and destroy the group while done() still holds or is about to take the mutex.
+	*/
+	class JobGroup
+	{
+	public:
+		void add(int count = 1)
+		{
+			std::lock_guard<std::mutex> lock(m);
+			pending += count;
+		}
+
+		void done()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			if (--pending == 0)
+				cv.notify_all();
+		}
+
+		bool is_done()
+		{
+			std::lock_guard<std::mutex> lock(m);
+			return pending <= 0;
+		}
+
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(m);
+			cv.wait(lock, [this] { return pending <= 0; });
+		}
+
+		bool wait_for(std::chrono::microseconds timeout)
+		{
+			std::unique_lock<std::mutex> lock(m);
+			return cv.wait_for(lock, timeout, [this] { return pending <= 0; });
+		}
+	private:
+		int pending = 0;
+		std::mutex m;
+		std::condition_variable cv;
+	};
+
+	/*
+	* Process wide executor shared by all cameras. Every worker owns a deque: it takes its own
+	* jobs from the back and, when idle, steals from the front of the other workers` deques.
+	* External threads distribute jobs round robin and sleep while waiting, so the number of
+	* runnable inference threads never exceeds the number of workers.
+	*/
+	class WorkStealingPool
+	{
+	public:
+		static WorkStealingPool* get_instance();
+
+		// max_workers <= 0 - one worker per hardware thread
+		bool init(int max_workers = 0);
+		void shutdown();
+
+		void submit(std::function<void()> job, JobGroup* group = nullptr);
+		// worker threads keep executing queued jobs while they wait, so nested waits can't deadlock
+		void wait(JobGroup& group);
+
+		int get_workers_count() const { return static_cast<int>(workers.size()); }
+		uint64_t get_executed() const { return executed; }
+		uint64_t get_stolen() const { return stolen; }
+		int get_queued() const { return queued; }
+		bool is_worker_thread() const;
+	private:
+		WorkStealingPool() {};
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+		~WorkStealingPool();
+
+		class pool_job
+		{
+		public:
+			std::function<void()> func;
+			JobGroup* group = nullptr;
+		};
+
+		class pool_worker
+		{
+		public:
+			std::deque<pool_job> jobs;
+			std::mutex m;
+			std::thread thread;
+		};
+
+		void worker_loop(int index);
+		bool try_get_job(int index, pool_job& job);
+		void execute(pool_job& job);
+
+		std::vector<pool_worker*> workers;
+		std::mutex init_mutex;
+
+		std::mutex sleep_mutex;
+		std::condition_variable sleep_cv;
+		bool is_stopping = false;
+
+		std::atomic<unsigned int> next_worker = 0;
+		std::atomic<int> queued = 0;
+		std::atomic<uint64_t> executed = 0;
+		std::atomic<uint64_t> stolen = 0;
+
+		static thread_local int worker_index;
+	};
+}
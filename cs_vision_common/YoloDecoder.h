@@ -0,0 +1,290 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace cs
+{
+	enum class YOLO_LAYOUT
+	{
+		YOLO_LAYOUT_V5 = 0,				// [anchors, 5 + classes], objectness in the 5th attribute
+		YOLO_LAYOUT_V8 = 1,				// [4 + classes, anchors], YOLOv8/YOLO11 as exported
+		YOLO_LAYOUT_V8_TRANSPOSED = 2	// [anchors, 4 + classes]
+	};
+
+	// candidates of one image, structure of arrays. x, y - top left corner in the model input coordinates
+	class yolo_candidates
+	{
+	public:
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> w;
+		std::vector<float> h;
+		std::vector<float> scores;
+		std::vector<int> class_ids;
+
+		size_t size() const { return scores.size(); };
+
+		void clear()
+		{
+			x.clear();
+			y.clear();
+			w.clear();
+			h.clear();
+			scores.clear();
+			class_ids.clear();
+		}
+
+		void add(float cx, float cy, float bw, float bh, float score, int class_id)
+		{
+			x.push_back(cx - 0.5f * bw);
+			y.push_back(cy - 0.5f * bh);
+			w.push_back(bw);
+			h.push_back(bh);
+			scores.push_back(score);
+			class_ids.push_back(class_id);
+		}
+	};
+
+	// affine quantization of an output tensor: real = (raw - zero_point) * scale
+	class yolo_quantization
+	{
+	public:
+		float scale = 1.0f;
+		int zero_point = 0;
+	};
+
+	namespace yolo_detail
+	{
+		// max of contiguous values. Lanes are independent, so compilers vectorize the loop without fast math
+		template<typename T>
+		inline T max_value(const T* p, int n)
+		{
+			constexpr int lanes = 8;
+			if (n < lanes) {
+				T m = p[0];
+				for (int i = 1; i < n; i++)
+					m = p[i] > m ? p[i] : m;
+				return m;
+			}
+
+			T m[lanes];
+			for (int k = 0; k < lanes; k++)
+				m[k] = p[k];
+
+			int i = lanes;
+			for (; i + lanes <= n; i += lanes) {
+				for (int k = 0; k < lanes; k++)
+					m[k] = p[i + k] > m[k] ? p[i + k] : m[k];
+			}
+
+			T res = m[0];
+			for (int k = 1; k < lanes; k++)
+				res = m[k] > res ? m[k] : res;
+			for (; i < n; i++)
+				res = p[i] > res ? p[i] : res;
+
+			return res;
+		}
+
+		// first index of the max, called only for the anchors passing the threshold
+		template<typename T>
+		inline int index_of(const T* p, int n, T value)
+		{
+			for (int i = 0; i < n; i++) {
+				if (p[i] == value)
+					return i;
+			}
+			return 0;
+		}
+
+		template<typename T>
+		inline float dequantize(T value, const yolo_quantization& quant)
+		{
+			if constexpr (std::is_same_v<T, float>)
+				return value;
+			else
+				return (static_cast<int>(value) - quant.zero_point) * quant.scale;
+		}
+
+		// real > threshold is raw > raw threshold, the scale is positive
+		template<typename T>
+		inline float raw_threshold(float threshold, const yolo_quantization& quant)
+		{
+			if constexpr (std::is_same_v<T, float>)
+				return threshold;
+			else
+				return threshold / quant.scale + quant.zero_point;
+		}
+	}
+
+	/*
+	* Decoder of raw YOLO outputs shared by the detector backends, the layout is a compile time parameter.
+	* Anchors are rejected before their box is read: by objectness (v5) or by the max class score, the class
+	* index is searched only for the survivors. Output of one image is decoded per call.
+	* Quantized outputs (int8/uint8) are compared with the threshold converted to the quantized domain,
+	* only the values of the surviving anchors are dequantized.
+	*/
+	template<YOLO_LAYOUT layout>
+	class YoloDecoder
+	{
+	public:
+		// data - output of one image, conf_threshold - minimal final score (objectness * class score for v5)
+		void decode(const float* data, int anchors, int classes, float conf_threshold, yolo_candidates& out)
+		{
+			decode(data, anchors, classes, conf_threshold, yolo_quantization(), out);
+		}
+
+		template<typename T>
+		void decode(const T* data, int anchors, int classes, float conf_threshold, const yolo_quantization& quant, yolo_candidates& out)
+		{
+			static_assert(std::is_same_v<T, float> || std::is_same_v<T, uint8_t> || std::is_same_v<T, int8_t>, "float, uint8 or int8 output");
+			if (data == nullptr || anchors <= 0 || classes <= 0 || quant.scale <= 0)
+				return;
+
+			if constexpr (layout == YOLO_LAYOUT::YOLO_LAYOUT_V8)
+				decode_planar(data, anchors, classes, conf_threshold, quant, out);
+			else
+				decode_rows(data, anchors, classes, conf_threshold, quant, out);
+		}
+	private:
+		std::vector<uint8_t> best_buffer;
+
+		// anchor per row, class scores of an anchor are contiguous
+		template<typename T>
+		void decode_rows(const T* data, int anchors, int classes, float conf_threshold, const yolo_quantization& quant, yolo_candidates& out)
+		{
+			constexpr bool is_v5 = layout == YOLO_LAYOUT::YOLO_LAYOUT_V5;
+			constexpr int offset = is_v5 ? 5 : 4;
+			const int stride = classes + offset;
+			const float raw_threshold = yolo_detail::raw_threshold<T>(conf_threshold, quant);
+
+			for (int i = 0; i < anchors; i++) {
+				const T* row = data + static_cast<size_t>(i) * stride;
+				float objectness = 1.0f;
+				if constexpr (is_v5) {
+					if (row[4] <= raw_threshold)
+						continue;
+					objectness = yolo_detail::dequantize(row[4], quant);
+				}
+
+				const T* scores = row + offset;
+				T best = yolo_detail::max_value(scores, classes);
+				if constexpr (!is_v5) {
+					if (best <= raw_threshold)
+						continue;
+				}
+				float score = yolo_detail::dequantize(best, quant) * objectness;
+				if (score <= conf_threshold)
+					continue;
+
+				out.add(yolo_detail::dequantize(row[0], quant), yolo_detail::dequantize(row[1], quant),
+					yolo_detail::dequantize(row[2], quant), yolo_detail::dequantize(row[3], quant),
+					score, yolo_detail::index_of(scores, classes, best));
+			}
+		}
+
+		// attribute per row. Max class score of every anchor is found while the class rows are scanned contiguously,
+		// the class index is searched only for the anchors above the threshold
+		template<typename T>
+		void decode_planar(const T* data, int anchors, int classes, float conf_threshold, const yolo_quantization& quant, yolo_candidates& out)
+		{
+			best_buffer.resize(static_cast<size_t>(anchors) * sizeof(T));
+
+			const T* scores = data + 4 * static_cast<size_t>(anchors);
+			T* best = reinterpret_cast<T*>(best_buffer.data());
+			for (int i = 0; i < anchors; i++)
+				best[i] = scores[i];
+
+			for (int c = 1; c < classes; c++) {
+				const T* row = scores + static_cast<size_t>(c) * anchors;
+				for (int i = 0; i < anchors; i++)
+					best[i] = row[i] > best[i] ? row[i] : best[i];
+			}
+
+			const float raw_threshold = yolo_detail::raw_threshold<T>(conf_threshold, quant);
+			const T* cx = data;
+			const T* cy = data + anchors;
+			const T* bw = data + 2 * static_cast<size_t>(anchors);
+			const T* bh = data + 3 * static_cast<size_t>(anchors);
+			for (int i = 0; i < anchors; i++) {
+				if (best[i] <= raw_threshold)
+					continue;
+
+				int class_id = 0;
+				for (int c = 0; c < classes; c++) {
+					if (scores[static_cast<size_t>(c) * anchors + i] == best[i]) {
+						class_id = c;
+						break;
+					}
+				}
+
+				out.add(yolo_detail::dequantize(cx[i], quant), yolo_detail::dequantize(cy[i], quant),
+					yolo_detail::dequantize(bw[i], quant), yolo_detail::dequantize(bh[i], quant),
+					yolo_detail::dequantize(best[i], quant), class_id);
+			}
+		}
+	};
+
+	// layout chosen at runtime (from the model`s output shape), every call goes to the specialized decoder
+	class YoloOutputDecoder
+	{
+	public:
+		void set_layout(YOLO_LAYOUT layout) { this->layout = layout; };
+		YOLO_LAYOUT get_layout() const { return layout; };
+
+		// [anchors, attributes] with the anchors dimension longer is v5/v8 transposed, the other way is v8
+		static YOLO_LAYOUT detect_layout(int64_t dim1, int64_t dim2, bool has_objectness)
+		{
+			if (dim1 < dim2)
+				return YOLO_LAYOUT::YOLO_LAYOUT_V8;
+			return has_objectness ? YOLO_LAYOUT::YOLO_LAYOUT_V5 : YOLO_LAYOUT::YOLO_LAYOUT_V8_TRANSPOSED;
+		}
+
+		void decode(const float* data, int anchors, int classes, float conf_threshold, yolo_candidates& out)
+		{
+			decode(data, anchors, classes, conf_threshold, yolo_quantization(), out);
+		}
+
+		template<typename T>
+		void decode(const T* data, int anchors, int classes, float conf_threshold, const yolo_quantization& quant, yolo_candidates& out)
+		{
+			switch (layout) {
+			case YOLO_LAYOUT::YOLO_LAYOUT_V5: v5.decode(data, anchors, classes, conf_threshold, quant, out); break;
+			case YOLO_LAYOUT::YOLO_LAYOUT_V8: v8.decode(data, anchors, classes, conf_threshold, quant, out); break;
+			case YOLO_LAYOUT::YOLO_LAYOUT_V8_TRANSPOSED: v8t.decode(data, anchors, classes, conf_threshold, quant, out); break;
+			}
+		}
+	private:
+		YOLO_LAYOUT layout = YOLO_LAYOUT::YOLO_LAYOUT_V8;
+		YoloDecoder<YOLO_LAYOUT::YOLO_LAYOUT_V5> v5;
+		YoloDecoder<YOLO_LAYOUT::YOLO_LAYOUT_V8> v8;
+		YoloDecoder<YOLO_LAYOUT::YOLO_LAYOUT_V8_TRANSPOSED> v8t;
+	};
+}
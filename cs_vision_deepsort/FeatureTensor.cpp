@@ -20,6 +20,9 @@ FeatureTensor* FeatureTensor::getInstance(const wchar_t* model_path)
 
 FeatureTensor::FeatureTensor(const wchar_t* model_path)
 {
+    // one instance serves every tracker, its threads come from the process wide budget
+    options_ = Ort::SessionOptions();
+    options_.SetIntraOpNumThreads(cs::ThreadBudget::get_instance()->assign("deepsort_features", "ort"));
     session_ = Ort::Session{ env_, model_path, options_ };
 
     if (init()) {
@@ -47,6 +50,22 @@ bool FeatureTensor::init()
     inputDims_[0] = 1;
     std::cout << "FeatureTensor::init() " << std::endl;
 
+    // Normalization parameters obtained from your custom model
+    cs::tensor_pack_params pack;
+    pack.width = static_cast<int>(inputDims_.at(3));
+    pack.height = static_cast<int>(inputDims_.at(2));
+    pack.layout = cs::TENSOR_LAYOUT::TENSOR_LAYOUT_NCHW;
+    pack.type = cs::TENSOR_TYPE::TENSOR_TYPE_FLOAT32;
+    pack.resize = cs::TENSOR_RESIZE::TENSOR_RESIZE_STRETCH;
+    pack.is_swap_rb = true;
+    pack.mean[0] = 0.485f;
+    pack.mean[1] = 0.456f;
+    pack.mean[2] = 0.406f;
+    pack.stddev[0] = 0.229f;
+    pack.stddev[1] = 0.224f;
+    pack.stddev[2] = 0.225f;
+    packer_.set_params(pack);
+
     return true;
 }
 
@@ -56,46 +75,14 @@ void FeatureTensor::preprocess(cv::Mat &imageBGR, std::vector<float> &inputTenso
         std::cerr << "Error: Input image is empty." << std::endl;
         return;
 	}
-    // pre-processing the Image
-    //  step 1: Read an image in HWC BGR UINT8 format.
-    //  cv::Mat imageBGR = cv::imread(imageFilepath, cv::ImreadModes::IMREAD_COLOR);
-
-    // step 2: Resize the image.
-    cv::Mat resizedImageBGR, resizedImageRGB, resizedImage, preprocessedImage;
-       cv::resize(imageBGR, resizedImageBGR,
-                  cv::Size(inputDims_.at(3), inputDims_.at(2)),
-                  cv::InterpolationFlags::INTER_CUBIC);
-
-    // cv::resize(imageBGR, resizedImageBGR,
-    //            cv::Size(64, 128));
-
-    // step 3: Convert the image to HWC RGB UINT8 format.
-    cv::cvtColor(resizedImageBGR, resizedImageRGB,
-                 cv::ColorConversionCodes::COLOR_BGR2RGB);
-    // step 4: Convert the image to HWC RGB float format by dividing each pixel by 255.
-    resizedImageRGB.convertTo(resizedImage, CV_32F, 1.0 / 255);
-
-    // step 5: Split the RGB channels from the image.
-    cv::Mat channels[3];
-    cv::split(resizedImage, channels);
-
-    // step 6: Normalize each channel.
-    //  Normalization per channel
-    //  Normalization parameters obtained from your custom model
-
-    channels[0] = (channels[0] - 0.485) / 0.229;
-    channels[1] = (channels[1] - 0.456) / 0.224;
-    channels[2] = (channels[2] - 0.406) / 0.225;
-
-    // step 7: Merge the RGB channels back to the image.
-    cv::merge(channels, 3, resizedImage);
-
-    // step 8: Convert the image to CHW RGB float format.
-    // HWC to CHW
-    cv::dnn::blobFromImage(resizedImage, preprocessedImage);
+
+    // HWC BGR UINT8 -> resized CHW RGB normalized float, written directly into the tensor values
     inputTensorSize = vectorProduct(inputDims_);
-    inputTensorValues.assign(preprocessedImage.begin<float>(),
-                             preprocessedImage.end<float>());
+    inputTensorValues.resize(inputTensorSize);
+
+    std::lock_guard<std::mutex> lock(packer_mutex_);
+    if (!packer_.pack(imageBGR.data, imageBGR.step, imageBGR.cols, imageBGR.rows, imageBGR.channels(), inputTensorValues.data()))
+        inputTensorValues.clear();
 }
 
 bool FeatureTensor::getRectsFeature(const cv::Mat &img, DETECTIONS& d, const char* input_tensor_name, const char* output_tensor_name)
@@ -104,6 +91,10 @@ bool FeatureTensor::getRectsFeature(const cv::Mat &img, DETECTIONS& d, const cha
 		return false;
 	}
 
+    // reused by every box
+    std::vector<float> inputTensorValues;
+    size_t inputTensorSize = 0;
+
     for (DETECTION_ROW& dbox : d) {
         cv::Rect rc = cv::Rect(int(dbox.tlwh(0)), int(dbox.tlwh(1)),
             int(dbox.tlwh(2)), int(dbox.tlwh(3)));
@@ -118,10 +109,8 @@ bool FeatureTensor::getRectsFeature(const cv::Mat &img, DETECTIONS& d, const cha
             return false;
 		}
 
-        cv::Mat mattmp = img(rc).clone();
+        cv::Mat mattmp = img(rc);
 
-        std::vector<float> inputTensorValues;
-        size_t inputTensorSize;
         preprocess(mattmp, inputTensorValues, inputTensorSize);
         if (inputTensorValues.empty()) {
             std::cerr << "Error: Preprocessed input tensor values are empty." << std::endl;
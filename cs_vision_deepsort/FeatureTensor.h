@@ -22,7 +22,10 @@
 #include <opencv2/dnn/dnn.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include <mutex>
 #include "IObjectDetector.h"
+#include "TensorPacker.h"
+#include "ThreadBudget.h"
 
 typedef unsigned char uint8;
 
@@ -64,6 +67,10 @@ private:
 
     void tobuffer(const std::vector<cv::Mat> &imgs, uint8 *buf);
 
+    // resize, BGR->RGB and ImageNet normalization into the CHW input in one pass
+    cs::TensorPacker packer_;
+    std::mutex packer_mutex_;
+
 public:
     void test();
 
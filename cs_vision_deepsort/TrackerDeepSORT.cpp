@@ -49,13 +49,13 @@ void TrackerDeepSORT::clear()
 
 }
 
-int TrackerDeepSORT::detect(cv::Mat* input, int& current_id, bool is_draw, std::list<DetectionItem*>* detections)
+int TrackerDeepSORT::detect(cv::Mat* input, int& current_id, bool is_draw, DetectionSpan detections)
 {
 	if (input == nullptr || input->empty()) {
 		return 0;
 	}
 
-	if (detections == nullptr || detections->empty()) {
+	if (detections.empty()) {
 		return 0;
 	}
 
@@ -63,7 +63,7 @@ int TrackerDeepSORT::detect(cv::Mat* input, int& current_id, bool is_draw, std::
 
 	std::vector<DETECTION_ROW> input_detections;
 
-	for (auto& detection : *detections) {
+	for (auto& detection : detections) {
 		if (detection == nullptr)
 			continue;
 
@@ -92,7 +92,7 @@ int TrackerDeepSORT::detect(cv::Mat* input, int& current_id, bool is_draw, std::
 			if (!tracker->tracks[i].is_confirmed() || tracker->tracks[i].time_since_update > 1)
 				continue;
 
-			DetectionItem* item = new DetectionItem();
+			DetectionItem* item = create_detection();
 			item->color = color;
 			item->id = current_id;
 			current_id++;
@@ -101,10 +101,8 @@ int TrackerDeepSORT::detect(cv::Mat* input, int& current_id, bool is_draw, std::
 			item->class_id = input_detections[i].class_id;
 			item->detector_id = id;
 
-			std::string label;
-			get_rule_label(item->class_id, label);
 			item->priority = get_rule_priority(item->class_id);
-			item->label = trim(label);
+			item->set_label(get_label(item->class_id));
 			item->score = input_detections[i].confidence;
 			item->box.y = tracker->tracks[i].to_tlwh()[1];
 			item->box.x = tracker->tracks[i].to_tlwh()[0];
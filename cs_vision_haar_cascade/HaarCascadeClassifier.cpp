@@ -55,11 +55,9 @@ void HaarCascadeClassifier::postprocess(std::vector<cv::Rect>& features, int& cu
 		if (f.empty())
 			continue;
 
-		DetectionItem* item = new DetectionItem();
+		DetectionItem* item = create_detection();
 		if (item != nullptr) {
 			item->color = color;
-
-			DetectionItem* item = new DetectionItem();
 			item->id = current_id;
 			item->detector_id = id;
 			current_id++;
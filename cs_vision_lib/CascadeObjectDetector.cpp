@@ -0,0 +1,267 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "CascadeObjectDetector.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include "camera_loop_utils.h"
+
+using namespace cs;
+using namespace cv;
+using namespace std;
+
+int CascadeObjectDetector::init(object_detector_environment& env)
+{
+	load_rules(env.rules_path.c_str());
+
+	// kinds available differ between the builds, so they have no default. The heavy model is of the fast one`s kind by default
+	int fast_kind = -1;
+	int heavy_kind = -1;
+	if (env.additional != nullptr) {
+		fast_kind = env.additional->get<int>("cascade_fast_kind", fast_kind);
+		heavy_kind = env.additional->get<int>("cascade_heavy_kind", fast_kind);
+		params.mode = static_cast<CASCADE_MODE>(env.additional->get<int>("cascade_mode", static_cast<int>(params.mode)));
+		params.region_padding = env.additional->get<int>("cascade_region_padding_percent", 50) / 100.0f;
+		params.max_regions = env.additional->get<int>("cascade_max_regions", params.max_regions);
+		params.merge_iou = env.additional->get<int>("cascade_merge_iou_percent", 50) / 100.0f;
+	}
+
+	// the fast model is the model of the detector, the heavy one is set by the settings
+	fast = create_stage(env, "fast", fast_kind, env.model_path);
+	heavy = create_stage(env, "heavy", heavy_kind, "");
+	if (fast == nullptr || heavy == nullptr) {
+		clear();
+		return 0;
+	}
+
+	return 1;
+}
+
+IObjectDetector* CascadeObjectDetector::create_stage(object_detector_environment& env, const char* stage, int kind, const string& model_path)
+{
+	string prefix = string("cascade_") + stage;
+	if (kind < 0) {
+		cout << "[Cascade] " << prefix << "_kind isn`t set" << endl;
+		return nullptr;
+	}
+	if (kind == static_cast<int>(ObjectDetectorKind::OBJECT_DETECTOR_CASCADE)) {
+		cout << "[Cascade] " << prefix << "_kind can`t be a cascade" << endl;
+		return nullptr;
+	}
+
+	// rules of the cascade decide the final scores, the stages keep everything above their thresholds
+	object_detector_environment stage_env = env;
+	stage_env.model_path = model_path;
+	stage_env.rules_path = "";
+	if (env.additional != nullptr) {
+		stage_env.model_path = env.additional->get<string>(prefix + "_model_path", model_path);
+		stage_env.label_path = env.additional->get<string>(prefix + "_label_path", env.label_path);
+		stage_env.rules_path = env.additional->get<string>(prefix + "_rules_path", "");
+	}
+
+	if (stage_env.model_path.empty()) {
+		cout << "[Cascade] " << prefix << "_model_path isn`t set" << endl;
+		return nullptr;
+	}
+
+	IObjectDetector* detector = create_detector(kind);
+	if (detector == nullptr) {
+		cout << "[Cascade] " << prefix << "_kind " << kind << " isn`t supported by this build" << endl;
+		return nullptr;
+	}
+
+	if (detector->init(stage_env) == 0) {
+		cout << "[Cascade] " << stage << " model " << stage_env.model_path << " isn`t loaded" << endl;
+		delete detector;
+		return nullptr;
+	}
+
+	return detector;
+}
+
+void CascadeObjectDetector::clear()
+{
+	if (fast != nullptr) {
+		delete fast;
+		fast = nullptr;
+	}
+	if (heavy != nullptr) {
+		delete heavy;
+		heavy = nullptr;
+	}
+}
+
+int CascadeObjectDetector::detect(cv::Mat* input, int& current_id, bool is_draw, DetectionSpan detections)
+{
+	if (input == nullptr || input->empty() || fast == nullptr || heavy == nullptr)
+		return 0;
+
+	clear_last_detections();
+	confident.clear();
+	uncertain.clear();
+	heavy_results.clear();
+	frames++;
+
+	auto begin = chrono::steady_clock::now();
+	int fast_id = 0;
+	if (fast->detect(input, fast_id, false, detections) == 1) {
+		for (auto& d : fast->last_detections) {
+			DetectionRule* rule = get_rule(d->class_id);
+			if (rule == nullptr || (!rule->is_escalate && d->score >= rule->score))
+				confident.push_back(d);
+			else if (rule->is_escalate || (rule->escalate_score >= 0 && d->score >= rule->escalate_score))
+				uncertain.push_back(d);
+		}
+	}
+	auto end = chrono::steady_clock::now();
+	{
+		lock_guard<mutex> lock(timings_mutex);
+		fast_ms += chrono::duration<double, milli>(end - begin).count();
+		fast_count++;
+	}
+
+	if (!uncertain.empty()) {
+		escalated++;
+		begin = chrono::steady_clock::now();
+		run_heavy(input, detections);
+		end = chrono::steady_clock::now();
+
+		lock_guard<mutex> lock(timings_mutex);
+		heavy_ms += chrono::duration<double, milli>(end - begin).count();
+		heavy_count++;
+	}
+
+	merge(current_id);
+
+	return last_detections.size() > 0;
+}
+
+int CascadeObjectDetector::detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw)
+{
+	if (input == nullptr)
+		return 0;
+
+	cv::Mat img;
+	input->download(img);
+
+	return detect(&img, current_id, is_draw);
+}
+
+void CascadeObjectDetector::run_heavy(cv::Mat* input, DetectionSpan detections)
+{
+	int heavy_id = 0;
+
+	if (params.mode != CASCADE_MODE::CASCADE_MODE_REGIONS || static_cast<int>(uncertain.size()) > params.max_regions) {
+		if (heavy->detect(input, heavy_id, false, detections) == 1) {
+			for (auto& d : heavy->last_detections) {
+				heavy_results.push_back(*d);
+			}
+		}
+		return;
+	}
+
+	Rect frame_rect(0, 0, input->cols, input->rows);
+	for (auto& d : uncertain) {
+		float pad_w = d->box.width * params.region_padding;
+		float pad_h = d->box.height * params.region_padding;
+		Rect crop = Rect(Rect2f(d->box.x - pad_w, d->box.y - pad_h, d->box.width + 2 * pad_w, d->box.height + 2 * pad_h)) & frame_rect;
+		if (crop.empty())
+			continue;
+
+		Mat region = (*input)(crop);
+		regions++;
+		if (heavy->detect(&region, heavy_id, false) != 1)
+			continue;
+
+		for (auto& h : heavy->last_detections) {
+			heavy_results.push_back(*h);
+			heavy_results.back().box.x += crop.x;
+			heavy_results.back().box.y += crop.y;
+		}
+	}
+}
+
+/*
+* Results of the heavy model go first, so an object found by both models (or by overlapping crops)
+* keeps the heavy result. Uncertain results of the fast model are replaced by the heavy ones.
+*/
+void CascadeObjectDetector::merge(int& current_id)
+{
+	for (auto& h : heavy_results) {
+		cv::Scalar item_color = color;
+		if (!check_rule(h.class_id, h.score, item_color) || is_duplicate(h))
+			continue;
+
+		add_result(h, item_color, current_id);
+	}
+
+	for (auto& d : confident) {
+		cv::Scalar item_color = color;
+		check_rule(d->class_id, d->score, item_color);
+		if (is_duplicate(*d))
+			continue;
+
+		add_result(*d, item_color, current_id);
+	}
+}
+
+bool CascadeObjectDetector::is_duplicate(const DetectionItem& item)
+{
+	for (auto& d : last_detections) {
+		if (d->class_id != item.class_id)
+			continue;
+
+		float intersection = (d->box & item.box).area();
+		float united = d->box.area() + item.box.area() - intersection;
+		if (united > 0 && intersection / united >= params.merge_iou)
+			return true;
+	}
+
+	return false;
+}
+
+void CascadeObjectDetector::add_result(const DetectionItem& src, const cv::Scalar& item_color, int& current_id)
+{
+	DetectionItem* item = detections_arena.create(&src);
+	item->color = item_color;
+	item->id = current_id;
+	current_id++;
+
+	item->detector_id = id;
+	item->neural_network_id = neural_network_id;
+	item->priority = get_rule_priority(item->class_id);
+	item->batch_index = -1;
+
+	last_detections.push_back(item);
+}
+
+void CascadeObjectDetector::get_stage_durations(std::vector<std::pair<std::string, double>>& durations)
+{
+	lock_guard<mutex> lock(timings_mutex);
+	if (fast_count > 0)
+		durations.emplace_back("fast", fast_ms / fast_count);
+	if (heavy_count > 0)
+		durations.emplace_back("heavy", heavy_ms / heavy_count);
+}
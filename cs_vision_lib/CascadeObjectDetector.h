@@ -0,0 +1,100 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "IObjectDetector.h"
+
+namespace cs
+{
+	enum class CASCADE_MODE
+	{
+		CASCADE_MODE_FRAME = 0,		// the heavy model gets the whole image
+		CASCADE_MODE_REGIONS = 1	// the heavy model gets crops around the uncertain detections
+	};
+
+	class cascade_params
+	{
+	public:
+		CASCADE_MODE mode = CASCADE_MODE::CASCADE_MODE_FRAME;
+		float region_padding = 0.5f; // crops are grown by the part of the box size on every side
+		int max_regions = 4; // more uncertain detections escalate the whole image
+		float merge_iou = 0.5f; // results of the same class overlapping more are the same object, the heavy one is kept
+	};
+
+	/*
+	* Meta detector of two models. The fast model runs on every image, the heavy one only when the fast model
+	* is unsure: a score is in the uncertain band of the class rule or the class rule asks for escalation.
+	* Confident results of the fast model are merged with the results of the heavy model, the rules of
+	* the cascade decide the final scores. Both models are expected to have the same classes.
+	*/
+	class CascadeObjectDetector : public IObjectDetector
+	{
+	public:
+		CascadeObjectDetector() {};
+		virtual ~CascadeObjectDetector() { clear(); };
+
+		virtual int init(object_detector_environment& env) override;
+
+		virtual void clear();
+		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, DetectionSpan detections = {}) override;
+		virtual int detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw = false) override;
+		virtual int detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw = false) override { return 0; };
+		virtual void get_stage_durations(std::vector<std::pair<std::string, double>>& durations) override;
+
+		uint64_t get_frames() const { return frames; }
+		uint64_t get_escalated() const { return escalated; }
+		uint64_t get_regions() const { return regions; }
+		// part of the images the heavy model was executed on
+		double get_escalation_fraction() const { return frames > 0 ? static_cast<double>(escalated) / frames : 0; }
+	private:
+		IObjectDetector* fast = nullptr;
+		IObjectDetector* heavy = nullptr;
+		cascade_params params;
+
+		std::vector<DetectionItem*> confident;
+		std::vector<DetectionItem*> uncertain;
+		std::vector<DetectionItem> heavy_results; // copies, the heavy detector`s items are reused by every crop
+
+		std::atomic<uint64_t> frames = 0;
+		std::atomic<uint64_t> escalated = 0;
+		std::atomic<uint64_t> regions = 0;
+
+		std::mutex timings_mutex;
+		double fast_ms = 0; // totals
+		double heavy_ms = 0;
+		uint64_t fast_count = 0;
+		uint64_t heavy_count = 0;
+
+		IObjectDetector* create_stage(object_detector_environment& env, const char* stage, int kind, const std::string& model_path);
+		void run_heavy(cv::Mat* input, DetectionSpan detections);
+		void merge(int& current_id);
+		bool is_duplicate(const DetectionItem& item);
+		void add_result(const DetectionItem& src, const cv::Scalar& item_color, int& current_id);
+	};
+}
@@ -0,0 +1,188 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "CrossCameraBatcher.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace cs;
+
+//******************************************************************************************
+// BatchGroup
+BatchGroup::BatchGroup(IObjectDetector* engine, int max_batch, std::chrono::microseconds max_latency)
+	: engine(engine), max_batch(std::max(max_batch, 1)), max_latency(max_latency)
+{
+}
+
+BatchGroup::~BatchGroup()
+{
+	if (engine != nullptr)
+		delete engine;
+}
+
+void BatchGroup::infer(const std::vector<cv::Mat*>& images, const detection_callback& on_detection)
+{
+	if (images.empty())
+		return;
+
+	batch_request req;
+	req.images = &images;
+	req.on_detection = &on_detection;
+	req.arrived = std::chrono::steady_clock::now();
+
+	std::unique_lock<std::mutex> lock(m);
+	queue.push_back(&req);
+	queued_images += images.size();
+	cv.notify_all();
+
+	while (req.done < images.size()) {
+		if (!is_executing && queued_images > 0) {
+			auto deadline = queue.front()->arrived + max_latency;
+			if (queued_images >= static_cast<size_t>(max_batch) || std::chrono::steady_clock::now() >= deadline)
+				execute(lock);
+			else
+				cv.wait_until(lock, deadline);
+			continue;
+		}
+
+		cv.wait(lock);
+	}
+}
+
+// takes up to max_batch queued images, lock is released during the inference
+void BatchGroup::execute(std::unique_lock<std::mutex>& lock)
+{
+	is_executing = true;
+
+	std::vector<std::pair<batch_request*, size_t>> slots;
+	std::vector<cv::Mat*> batch;
+	while (!queue.empty() && batch.size() < static_cast<size_t>(max_batch)) {
+		batch_request* req = queue.front();
+		while (req->next < req->images->size() && batch.size() < static_cast<size_t>(max_batch)) {
+			slots.emplace_back(req, req->next);
+			batch.push_back((*req->images)[req->next]);
+			req->next++;
+		}
+
+		if (req->next == req->images->size())
+			queue.pop_front();
+	}
+	queued_images -= batch.size();
+
+	lock.unlock();
+
+	try {
+		int current_id = 0;
+		if (batch.size() > 1 && engine->detect_batch(batch, current_id, false) == 1) {
+			for (auto& d : engine->last_detections) {
+				if (d->batch_index >= 0 && d->batch_index < static_cast<int>(slots.size()))
+					(*slots[d->batch_index].first->on_detection)(slots[d->batch_index].second, d);
+			}
+		}
+		else {
+			for (size_t i = 0; i < batch.size(); i++) {
+				if (engine->detect(batch[i], current_id, false) == 1) {
+					for (auto& d : engine->last_detections) {
+						(*slots[i].first->on_detection)(slots[i].second, d);
+					}
+				}
+			}
+		}
+	}
+	catch (const std::exception& e) {
+		std::cout << "[BatchGroup] Error: " << e.what() << std::endl;
+	}
+
+	batches++;
+	images_count += batch.size();
+
+	lock.lock();
+	for (auto& slot : slots) {
+		slot.first->done++;
+	}
+	is_executing = false;
+	cv.notify_all();
+}
+
+//******************************************************************************************
+// CrossCameraBatcher
+CrossCameraBatcher* CrossCameraBatcher::get_instance()
+{
+	static CrossCameraBatcher instance;
+	return &instance;
+}
+
+BatchGroup* CrossCameraBatcher::join(const std::string& model, const std::string& options, const std::function<IObjectDetector*()>& create, int max_batch, int max_latency_ms)
+{
+	std::lock_guard<std::mutex> lock(m);
+
+	std::string key = model + "|" + options;
+	auto it = groups.find(key);
+	if (it != groups.end()) {
+		it->second.refs++;
+		return it->second.group;
+	}
+
+	for (auto& group : groups) {
+		if (group.first.compare(0, model.size() + 1, model + "|") == 0) {
+			std::cout << "[CrossCameraBatcher] " << model << " is shared by cameras with different settings, the model is loaded once per settings" << std::endl;
+			break;
+		}
+	}
+
+	IObjectDetector* engine = create();
+	if (engine == nullptr)
+		return nullptr;
+
+	if (max_batch <= 0)
+		max_batch = engine->get_model_batch_size();
+	// models without batching report 1, the cameras then only share the instance and take turns on it
+	if (max_batch <= 1)
+		std::cout << "[CrossCameraBatcher] " << model << " batch size is 1, images of the cameras are inferred one by one. Use a model with batching and set cross_camera_batch_size" << std::endl;
+
+	group_entry entry;
+	entry.group = new BatchGroup(engine, max_batch, std::chrono::milliseconds(std::max(max_latency_ms, 0)));
+	entry.refs = 1;
+	groups[key] = entry;
+
+	return entry.group;
+}
+
+void CrossCameraBatcher::leave(BatchGroup* group)
+{
+	if (group == nullptr)
+		return;
+
+	std::lock_guard<std::mutex> lock(m);
+	for (auto it = groups.begin(); it != groups.end(); ++it) {
+		if (it->second.group != group)
+			continue;
+
+		if (--it->second.refs <= 0) {
+			delete it->second.group;
+			groups.erase(it);
+		}
+		return;
+	}
+}
@@ -0,0 +1,113 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include "IObjectDetector.h"
+
+namespace cs
+{
+	/*
+	* One model instance shared by the cameras configured with the same model. Images of the cameras are collected
+	* until max_batch images are waiting or the oldest request waited max_latency, then they go through one detect_batch call.
+	* There is no dispatcher thread: a waiting caller which finds the batch ready executes it and hands the results
+	* to the other callers (leader/followers), callers are blocked in infer() until their images are processed.
+	*/
+	class BatchGroup
+	{
+	public:
+		// called by the executing thread for every detection, index - position of the image in the caller`s list
+		using detection_callback = std::function<void(size_t index, DetectionItem* item)>;
+
+		BatchGroup(IObjectDetector* engine, int max_batch, std::chrono::microseconds max_latency);
+		virtual ~BatchGroup();
+
+		void infer(const std::vector<cv::Mat*>& images, const detection_callback& on_detection);
+
+		int get_max_batch() const { return max_batch; };
+		double get_mean_batch_size() const { return batches > 0 ? static_cast<double>(images_count) / batches : 0; };
+	private:
+		class batch_request
+		{
+		public:
+			const std::vector<cv::Mat*>* images = nullptr;
+			const detection_callback* on_detection = nullptr;
+			size_t next = 0;	// first image not taken by a batch yet
+			size_t done = 0;
+			std::chrono::steady_clock::time_point arrived;
+		};
+
+		void execute(std::unique_lock<std::mutex>& lock);
+
+		IObjectDetector* engine = nullptr;
+		int max_batch = 1;
+		std::chrono::microseconds max_latency;
+
+		std::mutex m;
+		std::condition_variable cv;
+		std::deque<batch_request*> queue;
+		size_t queued_images = 0;
+		bool is_executing = false;
+
+		std::atomic<uint64_t> batches = 0;
+		std::atomic<uint64_t> images_count = 0;
+	};
+
+	/*
+	* Process wide registry of the batch groups, keyed by the model (detector kind and model path) and by the options
+	* the model is initialized with. Cameras with the same model and different options get separate instances.
+	*/
+	class CrossCameraBatcher
+	{
+	public:
+		static CrossCameraBatcher* get_instance();
+
+		// create - loads the shared model, called only by the first camera of the group
+		BatchGroup* join(const std::string& model, const std::string& options, const std::function<IObjectDetector*()>& create, int max_batch, int max_latency_ms);
+		void leave(BatchGroup* group);
+	private:
+		CrossCameraBatcher() {};
+
+		class group_entry
+		{
+		public:
+			BatchGroup* group = nullptr;
+			int refs = 0;
+		};
+
+		std::mutex m;
+		std::map<std::string, group_entry> groups;
+	};
+}
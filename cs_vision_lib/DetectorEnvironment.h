@@ -25,8 +25,10 @@
 #include <list>
 #include <atomic>
 #include <map>
+#include <mutex>
 #include <opencv2/dnn_superres.hpp>
 #include "IObjectDetector.h"
+#include "DetectorGraph.h"
 #include "std_utils.h"
 #include "MQTTClient.h"
 #ifdef __WITH_VIDEO_STREAMER__
@@ -44,15 +46,54 @@
 #include "aliases.h"
 #include "BaseQueue.h"
 #include "fps_counter.h"
-#include <semaphore>
+#include "FrameChannel.h"
+#include "Pipeline.h"
+#include "ObjectPool.h"
+#include "FramePool.h"
+#include "FrameTransform.h"
+#include "MotionGate.h"
+#include "RoiMask.h"
+#include <chrono>
 
 namespace cs
 {
+	class FrameContext
+	{
+	public:
+		// called when the context returns to the pool, detections are dropped in O(1)
+		void reset()
+		{
+			detections.clear();
+			arena.reset();
+			motion_regions.clear();
+			roi_frame.release();
+			frame.release();
+			sequence = 0;
+		}
+
+		cv::Mat frame;
+		DetectionArena arena;					// owns every detection of the frame
+		std::mutex arena_mutex;					// nodes of one graph level add detections concurrently
+		std::vector<DetectionItem*> detections;
+		std::vector<cv::Rect> motion_regions;	// changed areas found by the motion gate, empty - whole frame
+		cv::Mat roi_frame;						// camera zones cropped once per frame, shared by the root detectors
+		cv::Point roi_offset;
+		uint64_t sequence = 0;
+		std::chrono::steady_clock::time_point capture_time;
+	};
+
+	class ICamera;
+
 	class DetectorEnvironment
 	{
 	public:
 		virtual ~DetectorEnvironment()
 		{
+			stream_channel.close();
+			if (pipeline != nullptr)
+				delete pipeline;
+
+			detector_graph.clear();
 			clear<IObjectDetector, std::list>(detectors);
 
 #ifdef __WITH_VIDEO_STREAMER__
@@ -69,17 +110,26 @@ namespace cs
 				delete image_writer;
 		}
 
-		//std::binary_semaphore smphSignalMainToThread = std::binary_semaphore(0);
-		std::atomic_bool detector_ready = true;
-		std::atomic_bool is_can_show = true;
+		// declared before everything holding frames, buffers return to the pool before it is destroyed
+		FramePool frame_pool;
+		ObjectPool<FrameContext> context_pool;
+		Pipeline<FrameContext>* pipeline = nullptr;
+		uint64_t frame_sequence = 0;
+		FrameChannel<cv::Mat> stream_channel;	// capture/render -> stream
 
 		std::list<IObjectDetector*> detectors; //to do: shold be changed to map<int, IObjectDetector*>?
+		DetectorGraph detector_graph;
 
-		bool is_undistort = false;
-		cv::Mat map1, map2;
+		FrameTransform frame_transform; // undistort, flip and rotation in one pass
+		RoiMask roi;					// inference zones of the camera, empty - whole frame
 
-		cv::Mat* detect_frame;
-		cv::Mat show_frame;
+		MotionGate motion_gate;
+		// results of the last inferred frame, they are published again for the frames skipped by the gate
+		DetectionArena gated_arena;
+		std::vector<DetectionItem*> gated_detections;
+
+		cv::Mat* detect_frame = nullptr;
+		ICamera* capture = nullptr; // read by the stages for the statistics only
 
 		std::string topic = "";
 		std::string camera_id = "";
@@ -92,9 +142,21 @@ namespace cs
 		cv::Size border_dims;
 		cv::Scalar background_color = cv::Scalar(255, 255, 255);
 		aliases* field_aliases = nullptr;
-		std::string frame_title = "";
 		bool draw_fps = true;
 
+		// written by the inference stage, read by the render stage and the capture loop
+		void set_frame_title(const std::string& title)
+		{
+			std::lock_guard<std::mutex> lock(frame_title_mutex);
+			frame_title = title;
+		}
+
+		std::string get_frame_title()
+		{
+			std::lock_guard<std::mutex> lock(frame_title_mutex);
+			return frame_title;
+		}
+
 		IObjectDetector* get_detector(int detector_id)
 		{
 			for (auto& det : detectors) {
@@ -106,6 +168,7 @@ namespace cs
 		}
 
 		cv::dnn_superres::DnnSuperResImpl* super_resolution = nullptr;
+		std::mutex super_resolution_mutex; // detectors of one graph level upsample concurrently
 
 		bool mqtt = false;
 		MQTTClient* mqtt_client = nullptr;
@@ -133,5 +196,8 @@ namespace cs
 		bool execute_always = false;
 		cs::SCRIPT_EXECUTE_MODE execute_mode = cs::SCRIPT_EXECUTE_MODE::SCRIPT_EXECUTE_MODE_NONE;
 #endif
+	private:
+		std::string frame_title = "";
+		std::mutex frame_title_mutex;
 	};
 }
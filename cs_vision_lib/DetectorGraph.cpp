@@ -0,0 +1,128 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "DetectorGraph.h"
+
+using namespace std;
+using namespace cs;
+
+bool DetectorGraph::build(const std::list<IObjectDetector*>& detectors)
+{
+	clear();
+
+	for (auto& detector : detectors) {
+		DetectorNode* node = new DetectorNode();
+		node->detector = detector;
+		node->index = static_cast<int>(nodes.size());
+		nodes.push_back(node);
+	}
+
+	for (auto& node : nodes) {
+		IObjectDetector* detector = node->detector;
+
+		if (detector->predecessor_id >= 0 && detector->predecessor_class >= 0) {
+			for (auto& pred : nodes) {
+				if (pred->detector->id == detector->predecessor_id) {
+					node->parent = pred->index;
+					break;
+				}
+			}
+
+			if (node->parent < 0)
+				node->is_orphan = true;
+			else
+				node->depends.push_back(node->parent);
+		}
+
+		if (detector->get_is_uses_detections()) {
+			for (int i = 0; i < node->index; i++) {
+				if (i != node->parent)
+					node->depends.push_back(i);
+			}
+		}
+	}
+
+	// longest path from the sources, a node is placed when all its dependencies are placed
+	vector<bool> placed(nodes.size(), false);
+	size_t placed_count = 0;
+	bool is_progress = true;
+	while (placed_count < nodes.size() && is_progress) {
+		is_progress = false;
+		for (auto& node : nodes) {
+			if (placed[node->index])
+				continue;
+
+			bool is_ready = true;
+			int level = 0;
+			for (auto dep : node->depends) {
+				if (!placed[dep]) {
+					is_ready = false;
+					break;
+				}
+				level = max(level, nodes[dep]->level + 1);
+			}
+
+			if (is_ready) {
+				node->level = level;
+				placed[node->index] = true;
+				placed_count++;
+				is_progress = true;
+			}
+		}
+	}
+
+	is_serial = placed_count < nodes.size();
+	if (is_serial) {
+		for (auto& node : nodes) {
+			node->level = node->index;
+		}
+	}
+
+	for (auto& node : nodes) {
+		if (node->level >= static_cast<int>(levels.size()))
+			levels.resize(node->level + 1);
+		levels[node->level].push_back(node);
+	}
+
+	return !is_serial;
+}
+
+void DetectorGraph::clear()
+{
+	for (auto& node : nodes)
+		delete node;
+	nodes.clear();
+	levels.clear();
+	is_serial = false;
+}
+
+size_t DetectorGraph::get_max_width() const
+{
+	size_t width = 0;
+	for (auto& level : levels) {
+		width = max(width, level.size());
+	}
+
+	return width;
+}
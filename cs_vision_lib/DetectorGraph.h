@@ -0,0 +1,72 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <list>
+
+#include "IObjectDetector.h"
+
+namespace cs
+{
+	class DetectorNode
+	{
+	public:
+		IObjectDetector* detector = nullptr;
+		int index = 0;				// position in the detectors list, results are merged in this order
+		int parent = -1;			// node whose results are cropped for this detector, -1 - original frame
+		bool is_orphan = false;		// predecessor is not configured, detector never gets an image
+		std::vector<int> depends;
+		int level = 0;
+
+		// per frame state, touched only by the job executing the node and by the merge
+		std::vector<DetectionItem*> results;	// owned by the frame context arena
+		int ids_count = 0;
+	};
+
+	/*
+	* Execution plan of the camera`s detectors. Detector depends on its predecessor (predecessor_id/predecessor_class)
+	* and trackers depend on every detector listed before them, because they consume their results.
+	* Detectors of the same level are independent and can be executed in parallel.
+	*/
+	class DetectorGraph
+	{
+	public:
+		DetectorGraph() {};
+		virtual ~DetectorGraph() { clear(); };
+
+		bool build(const std::list<IObjectDetector*>& detectors);
+		void clear();
+
+		std::vector<DetectorNode*>& get_nodes() { return nodes; };
+		std::vector<std::vector<DetectorNode*>>& get_levels() { return levels; };
+		size_t get_max_width() const;
+		bool get_is_serial() const { return is_serial; };
+	private:
+		std::vector<DetectorNode*> nodes;
+		std::vector<std::vector<DetectorNode*>> levels;
+		bool is_serial = false; // dependencies have a cycle, detectors are executed in the list order
+	};
+}
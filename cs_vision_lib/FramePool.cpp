@@ -0,0 +1,305 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "FramePool.h"
+#include <iostream>
+
+using namespace std;
+using namespace cv;
+using namespace cs;
+
+FramePool::~FramePool()
+{
+	lock_guard<mutex> lock(m);
+
+	for (auto& it : free_buffers) {
+		for (auto buffer : it.second) {
+			fastFree(buffer);
+		}
+	}
+	free_buffers.clear();
+
+	if (used_buffers > 0)
+		cerr << "[FramePool] Destroyed with " << used_buffers << " buffers in use" << endl;
+}
+
+// buffer taken by acquire() under the pool lock, handed to allocate() called by Mat::create on the same thread
+static thread_local const FramePool* reserved_pool = nullptr;
+static thread_local uchar* reserved_data = nullptr;	// free buffer or nullptr - only the bytes are reserved
+static thread_local size_t reserved_size = 0;
+
+bool FramePool::acquire(cv::Mat& mat, int rows, int cols, int type)
+{
+	// the only owner of a buffer of the same geometry keeps it
+	if (mat.u != nullptr && mat.u->currAllocator == this && mat.u->refcount == 1 && mat.rows == rows && mat.cols == cols && mat.type() == type)
+		return true;
+
+	size_t bytes = static_cast<size_t>(rows) * cols * CV_ELEM_SIZE(type);
+	{
+		lock_guard<mutex> lock(m);
+		auto it = free_buffers.find(bytes);
+		if (it != free_buffers.end() && !it->second.empty()) {
+			reserved_data = it->second.back();
+			it->second.pop_back();
+			free_count--;
+			reused++;
+		}
+		else if (reserve_locked(bytes)) {
+			reserved_data = nullptr;
+			allocated_bytes += bytes;
+		}
+		else {
+			rejected++;
+			mat.release();
+			mat = Mat();
+			return false;
+		}
+		reserved_pool = this;
+		reserved_size = bytes;
+	}
+
+	mat.release();
+	mat = Mat();
+	mat.allocator = this;
+	mat.create(rows, cols, type);
+
+	// not taken by allocate(), the buffer or the reserved bytes go back to the pool
+	if (reserved_pool == this) {
+		lock_guard<mutex> lock(m);
+		if (reserved_data != nullptr) {
+			free_buffers[reserved_size].push_back(reserved_data);
+			free_count++;
+		}
+		else
+			allocated_bytes -= reserved_size;
+		reserved_pool = nullptr;
+		reserved_data = nullptr;
+		reserved_size = 0;
+	}
+
+	if (mat.u == nullptr || mat.u->currAllocator != this) {
+		mat.release();
+		mat = Mat();
+		return false;
+	}
+
+	return true;
+}
+
+void FramePool::set_memory_limit(size_t limit)
+{
+	lock_guard<mutex> lock(m);
+	memory_limit = limit;
+	if (memory_limit > 0 && allocated_bytes > memory_limit)
+		trim_locked(allocated_bytes - memory_limit);
+}
+
+bool FramePool::reserve_locked(size_t bytes) const
+{
+	if (memory_limit == 0)
+		return true;
+
+	if (allocated_bytes + bytes > memory_limit)
+		trim_locked(allocated_bytes + bytes - memory_limit);
+
+	return allocated_bytes + bytes <= memory_limit;
+}
+
+// frees unused buffers of any size until required bytes are released
+void FramePool::trim_locked(size_t required) const
+{
+	size_t released = 0;
+	for (auto it = free_buffers.begin(); it != free_buffers.end() && released < required;) {
+		auto& buffers = it->second;
+		while (!buffers.empty() && released < required) {
+			fastFree(buffers.back());
+			buffers.pop_back();
+			allocated_bytes -= it->first;
+			released += it->first;
+			free_count--;
+		}
+
+		if (buffers.empty())
+			it = free_buffers.erase(it);
+		else
+			++it;
+	}
+}
+
+UMatData* FramePool::allocate(int dims, const int* sizes, int type, void* data0, size_t* step, AccessFlag flags, UMatUsageFlags usage_flags) const
+{
+	size_t total = CV_ELEM_SIZE(type);
+	for (int i = dims - 1; i >= 0; i--) {
+		if (step) {
+			if (data0 && step[i] != CV_AUTOSTEP) {
+				CV_Assert(total <= step[i]);
+				total = step[i];
+			}
+			else
+				step[i] = total;
+		}
+		total *= sizes[i];
+	}
+
+	UMatData* u = new UMatData(this);
+	if (data0) {
+		u->data = u->origdata = static_cast<uchar*>(data0);
+		u->size = total;
+		u->flags |= UMatData::USER_ALLOCATED;
+		return u;
+	}
+
+	uchar* data = nullptr;
+	bool is_reserved = reserved_pool == this && reserved_size == total;
+	if (is_reserved) {
+		// acquire() already took the buffer or counted the bytes
+		data = reserved_data;
+		reserved_pool = nullptr;
+		reserved_data = nullptr;
+		reserved_size = 0;
+	}
+
+	{
+		lock_guard<mutex> lock(m);
+
+		if (!is_reserved) {
+			auto it = free_buffers.find(total);
+			if (it != free_buffers.end() && !it->second.empty()) {
+				data = it->second.back();
+				it->second.pop_back();
+				free_count--;
+				reused++;
+			}
+			else if (reserve_locked(total)) {
+				allocated_bytes += total;
+			}
+			else {
+				// OpenCV calls reallocating a pooled Mat get a regular buffer instead of an exception
+				rejected++;
+				delete u;
+				return Mat::getDefaultAllocator()->allocate(dims, sizes, type, data0, step, flags, usage_flags);
+			}
+		}
+
+		if (data == nullptr)
+			data = static_cast<uchar*>(fastMalloc(total));
+
+		used_bytes += total;
+		used_buffers++;
+		if (used_bytes > peak_used_bytes)
+			peak_used_bytes = used_bytes;
+	}
+
+	u->data = u->origdata = data;
+	u->size = total;
+
+	return u;
+}
+
+bool FramePool::allocate(UMatData* u, AccessFlag access_flags, UMatUsageFlags usage_flags) const
+{
+	return u != nullptr;
+}
+
+void FramePool::deallocate(UMatData* u) const
+{
+	if (u == nullptr)
+		return;
+
+	CV_Assert(u->urefcount == 0);
+	CV_Assert(u->refcount == 0);
+
+	if (!(u->flags & UMatData::USER_ALLOCATED)) {
+		lock_guard<mutex> lock(m);
+
+		used_bytes -= u->size;
+		used_buffers--;
+
+		if (memory_limit > 0 && allocated_bytes > memory_limit) {
+			fastFree(u->origdata);
+			allocated_bytes -= u->size;
+		}
+		else {
+			free_buffers[u->size].push_back(u->origdata);
+			free_count++;
+		}
+
+		u->origdata = nullptr;
+	}
+
+	delete u;
+}
+
+size_t FramePool::get_allocated_bytes() const
+{
+	lock_guard<mutex> lock(m);
+	return allocated_bytes;
+}
+
+size_t FramePool::get_used_bytes() const
+{
+	lock_guard<mutex> lock(m);
+	return used_bytes;
+}
+
+size_t FramePool::get_peak_used_bytes() const
+{
+	lock_guard<mutex> lock(m);
+	return peak_used_bytes;
+}
+
+int FramePool::get_used_buffers() const
+{
+	lock_guard<mutex> lock(m);
+	return used_buffers;
+}
+
+int FramePool::get_free_buffers() const
+{
+	lock_guard<mutex> lock(m);
+	return free_count;
+}
+
+uint64_t FramePool::get_reused() const
+{
+	lock_guard<mutex> lock(m);
+	return reused;
+}
+
+uint64_t FramePool::get_rejected() const
+{
+	lock_guard<mutex> lock(m);
+	return rejected;
+}
+
+double FramePool::get_occupancy() const
+{
+	lock_guard<mutex> lock(m);
+
+	size_t capacity = memory_limit > 0 ? memory_limit : allocated_bytes;
+	if (capacity == 0)
+		return 0;
+
+	return static_cast<double>(used_bytes) / capacity;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+namespace cs
+{
+	/*
+	* Per camera frame buffers allocator. Mats created with FramePool as allocator take 64 bytes aligned buffers
+	* from the pool and give them back when the last Mat header (ROIs included) is released, so stages share
+	* frames by OpenCV reference counting without copying and without malloc on every frame.
+	* memory_limit is a hard cap of the memory held by the pool (used and free buffers), 0 - unlimited.
+	*/
+	class FramePool : public cv::MatAllocator
+	{
+	public:
+		FramePool(size_t limit = 0) : memory_limit(limit) {};
+		virtual ~FramePool();
+
+		// mat gets a pooled buffer, returns false when the memory limit is reached
+		bool acquire(cv::Mat& mat, int rows, int cols, int type);
+		bool acquire(cv::Mat& mat, const cv::Size& size, int type) { return acquire(mat, size.height, size.width, type); };
+
+		void set_memory_limit(size_t limit);
+		size_t get_memory_limit() const { return memory_limit; };
+
+		size_t get_allocated_bytes() const;
+		size_t get_used_bytes() const;
+		size_t get_peak_used_bytes() const;
+		int get_used_buffers() const;
+		int get_free_buffers() const;
+		uint64_t get_reused() const;
+		uint64_t get_rejected() const;
+		double get_occupancy() const; // used part of the memory limit or of the allocated memory when there is no limit
+
+		cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override;
+		bool allocate(cv::UMatData* data, cv::AccessFlag access_flags, cv::UMatUsageFlags usage_flags) const override;
+		void deallocate(cv::UMatData* data) const override;
+	private:
+		mutable std::mutex m;
+		mutable std::map<size_t, std::vector<uchar*>> free_buffers;
+
+		size_t memory_limit = 0;
+		mutable size_t allocated_bytes = 0;
+		mutable size_t used_bytes = 0;
+		mutable size_t peak_used_bytes = 0;
+		mutable int used_buffers = 0;
+		mutable int free_count = 0;
+		mutable uint64_t reused = 0;
+		mutable uint64_t rejected = 0;
+
+		bool reserve_locked(size_t bytes) const;
+		void trim_locked(size_t required) const;
+	};
+}
@@ -0,0 +1,175 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "FrameTransform.h"
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/calib3d.hpp>
+#include "WorkStealingPool.h"
+
+using namespace std;
+using namespace cv;
+using namespace cs;
+
+bool FrameTransform::init(const cv::Size& size, const cv::Mat& K, const cv::Mat& D, bool is_flip, double angle)
+{
+	clear();
+
+	is_undistort = !K.empty() && !D.empty();
+	if (is_undistort) {
+		this->K = K.clone();
+		this->D = D.clone();
+	}
+	this->is_flip = is_flip;
+
+	this->angle = fmod(angle, 360.0);
+	if (this->angle < 0)
+		this->angle += 360.0;
+
+	if (size.width <= 0 || size.height <= 0)
+		return true; // built for the first frame
+
+	return build(size);
+}
+
+void FrameTransform::clear()
+{
+	mode = FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_NONE;
+	size = Size();
+	K.release();
+	D.release();
+	map1.release();
+	map2.release();
+	is_undistort = false;
+	is_flip = false;
+	angle = 0;
+}
+
+bool FrameTransform::build(const cv::Size& size)
+{
+	this->size = size;
+	map1.release();
+	map2.release();
+
+	if (!is_undistort) {
+		if (angle == 0) {
+			mode = is_flip ? FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_FLIP : FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_NONE;
+			flip_code = 1;
+			return true;
+		}
+
+		if (angle == 180) {
+			// rotation by 180 is a flip around both axes, with the horizontal flip only the vertical one is left
+			mode = FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_FLIP;
+			flip_code = is_flip ? 0 : -1;
+			return true;
+		}
+	}
+
+	// every pixel of the result is traced back to the source frame: inverse rotation, then flip, then undistort map
+	Mat r = getRotationMatrix2D(Point2f(static_cast<float>(size.width / 2.), static_cast<float>(size.height / 2.)), angle, 1.0);
+	Mat inv;
+	invertAffineTransform(r, inv);
+	const double* a = inv.ptr<double>(0);
+	const double* b = inv.ptr<double>(1);
+
+	Mat x(size, CV_32FC1), y(size, CV_32FC1);
+	for (int row = 0; row < size.height; row++) {
+		float* px = x.ptr<float>(row);
+		float* py = y.ptr<float>(row);
+		for (int col = 0; col < size.width; col++) {
+			double sx = a[0] * col + a[1] * row + a[2];
+			double sy = b[0] * col + b[1] * row + b[2];
+			if (is_flip)
+				sx = size.width - 1 - sx;
+
+			px[col] = static_cast<float>(sx);
+			py[col] = static_cast<float>(sy);
+		}
+	}
+
+	if (is_undistort) {
+		Mat ux, uy;
+		fisheye::initUndistortRectifyMap(K, D, Mat::eye(3, 3, CV_64F), K, size, CV_32FC1, ux, uy);
+
+		// points outside of the undistorted frame stay outside of the source frame
+		Mat cx, cy;
+		cv::remap(ux, cx, x, y, INTER_LINEAR, BORDER_CONSTANT, Scalar(-1));
+		cv::remap(uy, cy, x, y, INTER_LINEAR, BORDER_CONSTANT, Scalar(-1));
+		x = cx;
+		y = cy;
+	}
+
+	convertMaps(x, y, map1, map2, CV_16SC2);
+	mode = FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_REMAP;
+
+	return !map1.empty();
+}
+
+bool FrameTransform::apply(const cv::Mat& src, cv::Mat& dst)
+{
+	if (src.empty())
+		return false;
+
+	if (src.size() != size && !build(src.size()))
+		return false;
+
+	switch (mode) {
+	case FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_FLIP:
+		cv::flip(src, dst, flip_code);
+		break;
+	case FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_REMAP:
+		remap_bands(src, dst);
+		break;
+	default:
+		dst = src;
+		break;
+	}
+
+	return true;
+}
+
+void FrameTransform::remap_bands(const cv::Mat& src, cv::Mat& dst)
+{
+	dst.create(size, src.type());
+
+	int count = min(bands, size.height);
+	if (count <= 1) {
+		cv::remap(src, dst, map1, map2, INTER_LINEAR, BORDER_CONSTANT);
+		return;
+	}
+
+	// the maps are indexed by the result coordinates, so every band is an independent remap
+	WorkStealingPool* pool = WorkStealingPool::get_instance();
+	JobGroup group;
+	int rows = (size.height + count - 1) / count;
+	for (int begin = 0; begin < size.height; begin += rows) {
+		int end = min(begin + rows, size.height);
+		pool->submit([this, &src, &dst, begin, end]() {
+			Mat band = dst.rowRange(begin, end);
+			cv::remap(src, band, map1.rowRange(begin, end), map2.rowRange(begin, end), INTER_LINEAR, BORDER_CONSTANT);
+		}, &group);
+	}
+	pool->wait(group);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <opencv2/core.hpp>
+
+namespace cs
+{
+	/*
+	* Geometric preprocessing of the camera frames: fisheye undistort, horizontal flip and rotation around the
+	* center (the frame size is kept, as in cpu_rotate). The transforms are composed into one fixed point remap
+	* table, so a frame is read and written once. Flip and rotation by 180 without undistort are a single cv::flip.
+	* The table is built for the size of the first frame and rebuilt when the size changes.
+	*/
+	class FrameTransform
+	{
+	public:
+		FrameTransform() {};
+		virtual ~FrameTransform() {};
+
+		// K - 3x3 camera matrix, D - 4 fisheye distortion coefficients, empty - no undistort
+		bool init(const cv::Size& size, const cv::Mat& K, const cv::Mat& D, bool is_flip, double angle);
+		void clear();
+
+		// dst must not share data with src, it keeps its buffer when it already has the right geometry
+		bool apply(const cv::Mat& src, cv::Mat& dst);
+
+		bool get_is_identity() const { return !is_undistort && !is_flip && angle == 0; };
+		bool get_is_remap() const { return mode == FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_REMAP; };
+
+		// rows of the remapped frame are split into bands executed on the inference pool, 1 - the calling thread
+		void set_bands(int bands) { this->bands = bands > 0 ? bands : 1; };
+	private:
+		enum class FRAME_TRANSFORM_MODE
+		{
+			FRAME_TRANSFORM_MODE_NONE = 0,
+			FRAME_TRANSFORM_MODE_FLIP = 1,
+			FRAME_TRANSFORM_MODE_REMAP = 2
+		};
+
+		FRAME_TRANSFORM_MODE mode = FRAME_TRANSFORM_MODE::FRAME_TRANSFORM_MODE_NONE;
+		cv::Size size;
+		cv::Mat K, D;
+		bool is_undistort = false;
+		bool is_flip = false;
+		double angle = 0;
+		int flip_code = 1;
+		int bands = 1;
+		cv::Mat map1, map2;
+
+		bool build(const cv::Size& size);
+		void remap_bands(const cv::Mat& src, cv::Mat& dst);
+	};
+}
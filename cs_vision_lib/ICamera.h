@@ -29,6 +29,8 @@
 #include <opencv2/core.hpp>
 #include <opencv2/videoio.hpp>
 #include "settings.h"
+#include "FramePool.h"
+#include "FrameChannel.h"
 
 namespace cs
 {
@@ -83,8 +85,26 @@ namespace cs
 		virtual void bring_to_start() = 0;
 
 		virtual bool is_ready() { return ready_flag; }
-		virtual void set_ready(bool val) { ready_flag = val; }
+		virtual void set_ready(bool val)
+		{
+			ready_flag = val;
+			if (val)
+				ready_channel.put(true);
+		}
+		// sources filling their buffer in the background (microphone) signal it through the channel, the camera loop sleeps
+		// until then instead of polling is_ready(). false - still not ready after timeout
+		bool wait_ready(std::chrono::milliseconds timeout)
+		{
+			bool signal = false;
+			if (!is_ready())
+				ready_channel.take(signal, timeout);
+
+			return is_ready();
+		}
 		virtual void set_detector_buffer(size_t length) {}
+		virtual uint64_t get_skipped_frames() { return 0; }
+		// frames are captured into buffers of the camera`s pool
+		void set_frame_pool(FramePool* pool) { frame_pool = pool; }
 
 		bool source_is_file = false;
 	private:
@@ -92,6 +112,8 @@ namespace cs
 	protected:
 		std::variant<std::string, int> device;
 		std::atomic_bool ready_flag = true;
+		FrameChannel<bool> ready_channel;
+		FramePool* frame_pool = nullptr;
 	};
 }
 
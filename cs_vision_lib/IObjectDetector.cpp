@@ -35,6 +35,7 @@
 #include "std_utils.h"
 #include "JsonCOCOLabels.h"
 #include "types.h"
+#include "CrossCameraBatcher.h"
 #include <cv_utils.h>
 
 #ifdef __HAS_CUDA__
@@ -56,6 +57,133 @@ void default_error_reporter(void* user_data, const char* format, va_list args)
     std::cout << "Detector Error!!!" << std::endl;
 }
 
+IObjectDetector::~IObjectDetector()
+{
+    stop_async();
+
+    if (batch_group != nullptr)
+        CrossCameraBatcher::get_instance()->leave(batch_group);
+}
+
+void IObjectDetector::init_batch_member(object_detector_environment& env)
+{
+    load_rules(env.rules_path.c_str());
+    load_labels(env.label_path.c_str());
+}
+
+bool IObjectDetector::apply_batch_member(DetectionItem* item)
+{
+    cv::Scalar item_color = color;
+    if (!check_rule(item->class_id, item->score, item_color))
+        return false;
+
+    item->color = item_color;
+    item->priority = get_rule_priority(item->class_id);
+    item->detector_id = id;
+    item->neural_network_id = neural_network_id;
+    const std::string* label = get_label(item->class_id);
+    if (label != nullptr)
+        item->set_label(label);
+
+    return true;
+}
+
+std::future<detect_result> IObjectDetector::detect_async(cv::Mat input, int first_id, std::vector<DetectionItem> detections)
+{
+    auto promise = make_shared<std::promise<detect_result>>();
+    auto future = promise->get_future();
+
+    bool is_started = run_async([this, promise, input, first_id, detections = std::move(detections)]() mutable {
+        vector<DetectionItem*> consumed;
+        consumed.reserve(detections.size());
+        for (auto& d : detections) {
+            consumed.push_back(&d);
+        }
+
+        detect_result result;
+        std::exception_ptr error = nullptr;
+        int id = first_id;
+        try {
+            result.ret = detect(&input, id, false, consumed);
+            if (result.ret == 1) {
+                result.detections.reserve(last_detections.size());
+                for (auto& d : last_detections) {
+                    result.detections.push_back(*d);
+                }
+            }
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        result.ids_count = id - first_id;
+
+        // the detector is free before the caller wakes up, so its next call isn`t rejected as busy
+        end_async();
+        if (error != nullptr)
+            promise->set_exception(error);
+        else
+            promise->set_value(std::move(result));
+    });
+
+    if (!is_started) {
+        detect_result result;
+        result.ret = -1;
+        promise->set_value(std::move(result));
+    }
+
+    return future;
+}
+
+bool IObjectDetector::run_async(std::function<void()> job)
+{
+    lock_guard<mutex> lock(async_mutex);
+    if (is_async_busy || is_async_stopping)
+        return false;
+
+    is_async_busy = true;
+    async_calls++;
+    async_job = std::move(job);
+    if (!async_thread.joinable())
+        async_thread = std::thread(&IObjectDetector::async_loop, this);
+    async_cv.notify_all();
+
+    return true;
+}
+
+void IObjectDetector::async_loop()
+{
+    unique_lock<mutex> lock(async_mutex);
+    while (true) {
+        async_cv.wait(lock, [this] { return async_job != nullptr || is_async_stopping; });
+        if (async_job == nullptr)
+            break;
+
+        std::function<void()> job = std::move(async_job);
+        async_job = nullptr;
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
+
+void IObjectDetector::end_async()
+{
+    lock_guard<mutex> lock(async_mutex);
+    is_async_busy = false;
+}
+
+void IObjectDetector::stop_async()
+{
+    {
+        lock_guard<mutex> lock(async_mutex);
+        is_async_stopping = true;
+        async_cv.notify_all();
+    }
+
+    if (async_thread.joinable())
+        async_thread.join();
+}
+
 int IObjectDetector::infer(cv::Mat* input, int& current_id, bool show_mean, bool is_draw)
 {
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
@@ -82,6 +210,23 @@ float IObjectDetector::get_mean_detect_duration()
 
 void IObjectDetector::ProcessInputWithFloatModel(uint8_t* input, float* buffer, const int width, const int height, const int channels)
 {
+    if (channels == 3) {
+        // pixels as they are, HWC
+        if (input_packer.get_params().width != width || input_packer.get_params().height != height) {
+            tensor_pack_params pack;
+            pack.width = width;
+            pack.height = height;
+            pack.layout = TENSOR_LAYOUT::TENSOR_LAYOUT_NHWC;
+            pack.is_swap_rb = false;
+            for (int c = 0; c < 3; c++)
+                pack.stddev[c] = 1.0f / 255.0f;
+            input_packer.set_params(pack);
+        }
+
+        if (input_packer.pack(input, static_cast<size_t>(width) * channels, width, height, channels, buffer))
+            return;
+    }
+
     for (int y = 0; y < height; ++y) {
         float* out_row = buffer + (y * width * channels);
         for (int x = 0; x < width; ++x) {
@@ -169,6 +314,9 @@ void IObjectDetector::load_labels_coco_json(const char* label_path)
 
         delete(json);
     }
+
+    for (auto& label : labels)
+        label = trim(label);
 }
 
 void IObjectDetector::load_labels(const char* label_path)
@@ -201,22 +349,12 @@ DetectionRule* IObjectDetector::get_rule(int ind)
     return rule;
 }
 
-bool IObjectDetector::get_rule_label(int ind, string& label)
+const string* IObjectDetector::get_label(int ind)
 {
-    if (labels.size() == 0 || ind > labels.size())
-        return false;
-
-    bool ret = true;
+    if (ind < 0 || ind >= static_cast<int>(labels.size()))
+        return nullptr;
 
-    try {
-        label = trim(labels[ind]);
-    }
-    catch (...) {
-        label = "";
-        ret = false;
-    }
-
-    return ret;
+    return &labels[ind];
 }
 
 float IObjectDetector::get_rule_score(int ind)
@@ -278,6 +416,8 @@ int IObjectDetector::parse(Document& root)
             rule->execute_always = json_get_bool(_rule, "execute_always", false);
             rule->score = json_get_double(_rule, "score", 1);
             rule->color = cv_string_to_color(json_get_string(_rule, "color", "0x00FFFFFF"));
+            rule->escalate_score = json_get_double(_rule, "escalate_score", -1);
+            rule->is_escalate = json_get_bool(_rule, "escalate", false);
 
             rules[ind] = rule;
         }
@@ -291,35 +431,38 @@ int IObjectDetector::parse(Document& root)
 
 void IObjectDetector::draw_detection(cv::Mat* detect_frame, DetectionItem* detection)
 {
+    cv::Scalar color = detection->color;
+    const std::string& label = detection->get_label();
+
     switch (static_cast<int>(illustration_mode)) {
         case static_cast<int>(ILLUSTRATION_STYLE::ILLUSTRATION_STYLE_BOX):
-            rectangle(*detect_frame, static_cast<Rect>(detection->box), detection->color, 2, LINE_8);
+            rectangle(*detect_frame, static_cast<Rect>(detection->box), color, 2, LINE_8);
             break;
         case static_cast<int>(ILLUSTRATION_STYLE::ILLUSTRATION_STYLE_BOX_AND_TEXT):
-            rectangle(*detect_frame, static_cast<Rect>(detection->box), detection->color, 2, LINE_8);
-            draw_label(*detect_frame, detection->label, detection->box.x, detection->box.y, detection->color);
+            rectangle(*detect_frame, static_cast<Rect>(detection->box), color, 2, LINE_8);
+            draw_label(*detect_frame, label, detection->box.x, detection->box.y, color);
 			break;
         case static_cast<int>(ILLUSTRATION_STYLE::ILLUSTRATION_STYLE_MASK):
-            draw_mask(detection, detect_frame, detection->color);
+            draw_mask(detection, detect_frame, color);
             break;
         case static_cast<int>(ILLUSTRATION_STYLE::ILLUSTRATION_STYLE_MASK_AND_TEXT):
-            draw_mask(detection, detect_frame, detection->color);
-            draw_label(*detect_frame, detection->label, detection->box.x, detection->box.y, detection->color);
+            draw_mask(detection, detect_frame, color);
+            draw_label(*detect_frame, label, detection->box.x, detection->box.y, color);
             break;
         case static_cast<int>(ILLUSTRATION_STYLE::ILLUSTRATION_STYLE_BOX_AND_TEXT_AND_SCORE):
         {
-            rectangle(*detect_frame, static_cast<Rect>(detection->box), detection->color, 2, LINE_8);
-            //std::string label = std::format("{} ({:.2f})", detection->label, detection->score);
-            std::string label = cv::format("%s (%.2f)", detection->label, detection->score);
-            draw_label(*detect_frame, label, detection->box.x, detection->box.y, detection->color);
+            rectangle(*detect_frame, static_cast<Rect>(detection->box), color, 2, LINE_8);
+            //std::string text = std::format("{} ({:.2f})", label, detection->score);
+            std::string text = cv::format("%s (%.2f)", label.c_str(), detection->score);
+            draw_label(*detect_frame, text, detection->box.x, detection->box.y, color);
             break;
         }
         case static_cast<int>(ILLUSTRATION_STYLE::ILLUSTRATION_STYLE_MASK_AND_TEXT_AND_SCORE):
         {
-            draw_mask(detection, detect_frame, detection->color);
-            //std::string label = std::format("{} ({:.2f})", detection->label, detection->score);
-            std::string label = cv::format("%s (%.2f)", detection->label, detection->score);
-            draw_label(*detect_frame, label, detection->box.x, detection->box.y, detection->color);
+            draw_mask(detection, detect_frame, color);
+            //std::string text = std::format("{} ({:.2f})", label, detection->score);
+            std::string text = cv::format("%s (%.2f)", label.c_str(), detection->score);
+            draw_label(*detect_frame, text, detection->box.x, detection->box.y, color);
             break;
         }
         default:
@@ -347,7 +490,7 @@ void IObjectDetector::draw_mask(DetectionItem* det, cv::Mat* frame, const cv::Sc
     catch (...) {}
 }
 
-void IObjectDetector::draw_label(Mat& input_image, string& label, int left, int top, cv::Scalar& background_color)
+void IObjectDetector::draw_label(Mat& input_image, const string& label, int left, int top, cv::Scalar& background_color)
 {
     int base_line = 0;
     Size label_size = getTextSize(label, FONT_HERSHEY_COMPLEX, 0.7, 1, &base_line);
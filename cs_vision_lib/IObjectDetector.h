@@ -29,6 +29,13 @@
 #include <variant>
 #include <string>
 #include <chrono>
+#include <span>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
 #include <opencv2/core.hpp>
 #include <opencv2/core/types.hpp>
 #include "std_utils.h"
@@ -37,6 +44,9 @@
 #include "JsonWrapper.h"
 #include "dynamic_settings.h"
 #include "MQTTWrapper.h"
+#include "TensorPacker.h"
+#include "RoiMask.h"
+#include "TilePlanner.h"
 
 void default_error_reporter(void* user_data, const char* format, va_list args);
 
@@ -53,10 +63,19 @@ namespace cs
 		std::string on_detect = "";
 		bool execute_always = false;
 		cv::Scalar color = cv::Scalar(255, 255, 255);
+		// cascades: scores in [escalate_score, score) are uncertain and sent to the heavy model, -1 - no band
+		float escalate_score = -1;
+		bool is_escalate = false; // every detection of the class is sent to the heavy model
 
 		bool check(std::variant<int, std::string> item, float sc) { return item == object && sc >= score; };
 	};
 
+	/*
+	* Result of a detector. Fields read for every detection by the merge, trackers, drawing and publishing
+	* are packed into the first cache line, metadata follows. Labels of the model classes aren`t copied:
+	* label points into the labels of the detector, loaded once in load_labels(). Detectors producing
+	* free text (LLMs, audio) keep it in text.
+	*/
 	class DetectionItem
 	{
 	public:
@@ -67,68 +86,108 @@ namespace cs
 		DetectionItem() {};
 		DetectionItem(DetectionItem* item)
 		{
-			if (item == nullptr)
-				return;
-
-			this->id = item->id;
-			this->detector_id = item->detector_id;
-			this->kind = item->kind;
-			this->event = item->event;
-			this->id = item->id;
-			this->neural_network_id = item->neural_network_id;
-			this->class_id = item->class_id;
-			this->label = item->label;
-			this->priority = item->priority;
-			this->score = item->score;
-			this->box = item->box;
-			this->predecessor_id = item->predecessor_id;
-			this->predecessor_detector_id = item->predecessor_detector_id;
-			this->predecessor_class = item->predecessor_class;
-			this->color = item->color;
-
-			this->original_x = item->original_x;
-			this->original_y = item->original_y;
-			this->frame_w = item->frame_w;
-			this->frame_h = item->frame_h;
-			this->mapping_rule = item->mapping_rule;
-			this->is_draw = item->is_draw;
-			this->scale_factor = item->scale_factor;
-			this->is_send_result = item->is_send_result;
+			if (item != nullptr)
+				*this = *item;
 		}
 
-		ObjectDetectorKind kind = ObjectDetectorKind::OBJECT_DETECTOR_NONE;
-		ObjectDetectorEvent event = ObjectDetectorEvent::OBJECT_DETECTOR_EVENT_NONE;
+		// hot
+		cv::Rect2f box;
+		const std::string* label = nullptr;
+		float score = 0;
+		float priority = 0;
 		int id = -1;
-		int neural_network_id = -1;
-		int detector_id = -1;
 		int class_id = -1;
-		std::string label = "";
-		float priority = 0;
-		float score = 0;
-		cv::Rect2d box;
-		bool is_draw = false;
+		int detector_id = -1;
 		int predecessor_id = -1;
-		int predecessor_detector_id = -1;
-		int predecessor_class = -1;
-		cv::Scalar color = cv::Scalar(255, 255, 255);
-
 		int original_x = 0;
 		int original_y = 0;
+		int16_t scale_factor = 1;
+		int16_t batch_index = -1; // index of the input image in detect_batch
+		int16_t mapping_rule = RESULTS_MAPPING_RULE_NONE;
+		bool is_draw = false;
+		bool is_send_result = false;
+
+		// cold
+		std::string text = "";
+		ObjectDetectorKind kind = ObjectDetectorKind::OBJECT_DETECTOR_NONE;
+		ObjectDetectorEvent event = ObjectDetectorEvent::OBJECT_DETECTOR_EVENT_NONE;
+		int neural_network_id = -1;
+		int predecessor_detector_id = -1;
+		int predecessor_class = -1;
 		int frame_w = 0;
 		int frame_h = 0;
-		int mapping_rule = RESULTS_MAPPING_RULE_NONE;
-		int scale_factor = 1;
-		bool is_send_result = false;
+		cv::Vec4b color = cv::Vec4b(255, 255, 255, 0);
+
+		const std::string& get_label() const { return label != nullptr ? *label : text; }
+		void set_label(const std::string* interned) { label = interned; text.clear(); }
+		void set_label(const std::string& free_text) { label = nullptr; text = free_text; }
 
 		int get_id() { return id; }
 		int get_neural_network_id() { return neural_network_id; }
 		int get_class_id() { return class_id; }
 		float get_score() { return score; }
 
-		void set_color(int r, int g, int b) { this->color = cv::Scalar(r, g, b); }
+		void set_color(int r, int g, int b) { this->color = cv::Vec4b(cv::saturate_cast<uchar>(r), cv::saturate_cast<uchar>(g), cv::saturate_cast<uchar>(b), 0); }
 		void set_is_send_result(bool send) { is_send_result = send; }
 	};
 
+	/*
+	* Block storage of DetectionItems. Items are constructed once and reused: reset() only rewinds
+	* the counter, so steady state frames don`t touch the heap. Pointers stay valid until reset().
+	*/
+	class DetectionArena
+	{
+	public:
+		DetectionArena(size_t block_size = 64) : block_size(block_size > 0 ? block_size : 64) {};
+		virtual ~DetectionArena()
+		{
+			for (auto block : blocks)
+				delete[] block;
+			blocks.clear();
+		}
+
+		DetectionArena(const DetectionArena&) = delete;
+		DetectionArena& operator=(const DetectionArena&) = delete;
+
+		DetectionItem* create()
+		{
+			DetectionItem* item = next();
+			// keeps the text buffer
+			std::string text = std::move(item->text);
+			*item = DetectionItem();
+			text.clear();
+			item->text = std::move(text);
+			return item;
+		}
+
+		DetectionItem* create(const DetectionItem* src)
+		{
+			DetectionItem* item = next();
+			if (src != nullptr)
+				*item = *src;
+			return item;
+		}
+
+		void reset() { used = 0; };
+		size_t size() const { return used; };
+		size_t capacity() const { return blocks.size() * block_size; };
+	private:
+		std::vector<DetectionItem*> blocks;
+		size_t block_size = 64;
+		size_t used = 0;
+
+		DetectionItem* next()
+		{
+			size_t block = used / block_size;
+			if (block >= blocks.size())
+				blocks.push_back(new DetectionItem[block_size]);
+
+			return &blocks[block][used++ % block_size];
+		}
+	};
+
+	using DetectionSpan = std::span<DetectionItem* const>;
+
 	class object_detector_environment
 	{
 	public:
@@ -139,31 +198,54 @@ namespace cs
 		std::string output_tensor_name = "";
 		bool is_use_gpu = false;
 		int fps = 0;
+		int model_width = 0;	// 0 - taken from the model
+		int model_height = 0;
 		dynamic_settings* additional = nullptr;
 		void* param = nullptr; 
 		MQTTWrapper* mqtt_wrapper = nullptr;
 	};
 
+	// detections of one asynchronous detect call, owned by the future. Ids start from first_id of the call
+	class detect_result
+	{
+	public:
+		int ret = 0; // result of detect, -1 - not executed, the previous call is still running
+		int ids_count = 0;
+		std::vector<DetectionItem> detections;
+	};
+
+	class BatchGroup;
+
 	class IObjectDetector : public JsonWrapper
 	{
 	public:
 		IObjectDetector() {};
-		virtual ~IObjectDetector() {};
+		virtual ~IObjectDetector();
 
 		virtual int init(object_detector_environment& env) = 0;
 
 		virtual void clear() = 0;
 
-		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, std::list<DetectionItem*>* detections = nullptr) = 0;
+		// detections - results of the detectors executed before on the same frame
+		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, DetectionSpan detections = {}) = 0;
 		virtual int detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw = false) = 0;
+		// returns 1 when the whole batch was processed, items of last_detections have batch_index set. 0 - batching isn`t supported
 		virtual int detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw = false) = 0;
+		// default adapter of the synchronous detect: the call is executed on the detector`s own thread, one at a time.
+		// input and detections are taken by value, a caller giving up on the future leaves nothing dangling
+		virtual std::future<detect_result> detect_async(cv::Mat input, int first_id, std::vector<DetectionItem> detections = {});
+		// waits for the running asynchronous call, has to be called before a derived detector is destroyed
+		void stop_async();
+		bool get_is_async_busy() const { return is_async_busy; }
 
 		int infer(cv::Mat* input, int& current_id, bool show_mean, bool is_draw = true);
 		float get_mean_detect_duration();
+		// mean ms of the stages of detect as (stage, ms), left empty by detectors which don`t measure them
+		virtual void get_stage_durations(std::vector<std::pair<std::string, double>>& durations) {};
 
 		virtual void draw_detection(cv::Mat* detect_frame, DetectionItem* detection);
 		void draw_mask(DetectionItem* det, cv::Mat* frame, const cv::Scalar color = cv::Scalar(255, 255, 255));
-		void draw_label(cv::Mat& input_image, std::string& label, int left, int top, cv::Scalar& background_color);
+		void draw_label(cv::Mat& input_image, const std::string& label, int left, int top, cv::Scalar& background_color);
 
 		std::string name = "";
 		int id = 0;
@@ -182,9 +264,22 @@ namespace cs
 		bool is_draw_detections = false;
 		int illustration_mode = 0; // 0 - no illustration, 1 - draw boxes, 2 - draw masks
 		int scale_factor = 1;
+		int max_batch_size = 0; // limit of images per detect_batch call, 0 - limited by the model only
+		int detect_timeout_ms = 0; // deadline of the detector on a frame, 0 - the frame waits for it
 
 		cv::Scalar color = cv::Scalar(255, 255, 255);
 
+		// inference zones of the detector. root detectors get only the zones instead of the camera`s ones,
+		// crops of the predecessor are skipped when their center is outside of the zones
+		RoiMask roi;
+		TilePlanner tiles; // root detectors split large frames into overlapping tiles
+		BatchGroup* batch_group = nullptr; // model shared with other cameras, the detector has only labels and rules
+
+		// detector of a batch group: the model is loaded by the group, the detector keeps the labels and rules of its camera
+		void init_batch_member(object_detector_environment& env);
+		// results of a shared model get the detector`s identity, label and rule color. false - rejected by the rules
+		bool apply_batch_member(DetectionItem* item);
+
 		std::string on_detect = "";
 		bool execute_always = false;
 #ifdef __WITH_SCRIPT_LANG__
@@ -193,17 +288,32 @@ namespace cs
 
 		int results_mapping_rule = DetectionItem::RESULTS_MAPPING_RULE_ASIS;
 
-		std::list<DetectionItem*> last_detections;
+		// items are owned by the detector`s arena and valid until the next detect call
+		std::vector<DetectionItem*> last_detections;
 		void clear_last_detections()
 		{
-			::clear<DetectionItem, std::list>(last_detections);
+			last_detections.clear();
+			detections_arena.reset();
 		}
 
 		virtual bool get_is_check_proportions() { return true; };
+		// detector reads results of the detectors executed before it (trackers)
+		virtual bool get_is_uses_detections() { return false; };
+		virtual int get_model_batch_size() { return 1; };
+
+		void add_timeout() { timeouts++; }
+		void add_busy_skip() { busy_skips++; }
+		uint64_t get_async_calls() const { return async_calls; }
+		uint64_t get_timeouts() const { return timeouts; } // frames which went on without the detector`s results
+		uint64_t get_busy_skips() const { return busy_skips; } // frames skipped while a late call was still running
 	protected:
 		std::vector<std::string> labels;
 		std::map<int, DetectionRule*> rules;
 
+		DetectionArena detections_arena;
+		DetectionItem* create_detection() { return detections_arena.create(); };
+
+		TensorPacker input_packer;
 		void ProcessInputWithFloatModel(uint8_t* input, float* buffer, const int width, const int height, const int channels);
 		cv::Mat ProcessOutputWithFloatModel(float* input, const int width, const int height, const int channels);
 		void load_labels_txt(const char* label_path);
@@ -212,7 +322,8 @@ namespace cs
 		void load_rules(const char* rules_path);
 
 		DetectionRule* get_rule(int ind);
-		bool get_rule_label(int ind, std::string& label);
+		// label loaded by load_labels(), nullptr for unknown classes. Valid while the detector lives
+		const std::string* get_label(int ind);
 		float get_rule_score(int ind);
 		float get_rule_priority(int ind);
 		bool check_rule(int ind, float score, cv::Scalar& color);
@@ -225,5 +336,20 @@ namespace cs
 		bool if_json(const char* label_path);
 		int parse(rapidjson::Document& root) override;
 		MQTTWrapper* mqtt_wrapper = nullptr;
+
+		bool run_async(std::function<void()> job);
+		void async_loop();
+		void end_async();
+
+		std::thread async_thread;
+		std::mutex async_mutex;
+		std::condition_variable async_cv;
+		std::function<void()> async_job;
+		std::atomic<bool> is_async_busy = false;
+		bool is_async_stopping = false;
+
+		std::atomic<uint64_t> async_calls = 0;
+		std::atomic<uint64_t> timeouts = 0;
+		std::atomic<uint64_t> busy_skips = 0;
 	};
 }
@@ -44,7 +44,7 @@ void MQTTClient::prepare_root(Document& root)
 
 }
 
-void MQTTClient::send_detection(const char* camera_id, const char* topic, std::list<DetectionItem*> detections, aliases* field_aliases)
+void MQTTClient::send_detection(const char* camera_id, const char* topic, DetectionSpan detections, aliases* field_aliases)
 {
 	if (field_aliases == nullptr)
 		return send_detection(camera_id, topic, detections);
@@ -73,7 +73,7 @@ void MQTTClient::send_detection(const char* camera_id, const char* topic, std::l
 			name = field_aliases->get_alias(camera_id, topic, "nn_id", "nn_id");
 			object.AddMember(Value().SetString(name.c_str(), name.length(), allocator), it->neural_network_id, allocator);
 			name = field_aliases->get_alias(camera_id, topic, "label", "label");
-			object.AddMember(Value().SetString(name.c_str(), name.length(), allocator), Value().SetString(it->label.c_str(), it->label.length()), allocator);
+			object.AddMember(Value().SetString(name.c_str(), name.length(), allocator), Value().SetString(it->get_label().c_str(), it->get_label().length()), allocator);
 			name = field_aliases->get_alias(camera_id, topic, "conf", "conf");
 			object.AddMember(Value().SetString(name.c_str(), name.length(), allocator), it->score, allocator);
 			name = field_aliases->get_alias(camera_id, topic, "predecessor_object_id", "predecessor_object_id");
@@ -115,7 +115,7 @@ void MQTTClient::send_detection(const char* camera_id, const char* topic, std::l
 	root.GetAllocator().Clear();
 }
 
-void MQTTClient::send_detection(const char* camera_id, const char* topic, list<DetectionItem*> detections)
+void MQTTClient::send_detection(const char* camera_id, const char* topic, DetectionSpan detections)
 {
 	if (topic == NULL || strlen(topic) == 0)
 		return;
@@ -139,7 +139,7 @@ void MQTTClient::send_detection(const char* camera_id, const char* topic, list<D
 			object.AddMember("kind", (int)it->kind, allocator);
 			object.AddMember("cls", it->class_id, allocator);
 			object.AddMember("nn_id", it->neural_network_id, allocator);
-			object.AddMember("label", Value().SetString(it->label.c_str(), it->label.length()), allocator);
+			object.AddMember("label", Value().SetString(it->get_label().c_str(), it->get_label().length()), allocator);
 			object.AddMember("conf", it->score, allocator);
 			object.AddMember("predecessor_object_id", it->predecessor_id, allocator);
 			object.AddMember("predecessor_detector_id", it->predecessor_detector_id, allocator);
@@ -37,8 +37,8 @@ namespace cs
 		MQTTClient();
 		MQTTClient(struct mosquitto* mosq);
 
-		void send_detection(const char* camera_id, const char* topic, std::list<DetectionItem*> detections);
-		void send_detection(const char* camera_id, const char* topic, std::list<DetectionItem*> detections, aliases* field_aliases);
+		void send_detection(const char* camera_id, const char* topic, DetectionSpan detections);
+		void send_detection(const char* camera_id, const char* topic, DetectionSpan detections, aliases* field_aliases);
 		void send_command_response(int command_id, const char* device_id, const char* topic, uint64_t req_id, int error_code, const char* error_string);
 	private:
 		void _send(const char* topic, rapidjson::Document& root);
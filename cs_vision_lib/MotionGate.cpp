@@ -0,0 +1,133 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "MotionGate.h"
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace cs;
+
+void MotionGate::init(bool is_enabled, int width, int threshold, double min_area, int idle_interval_ms, double learning_rate)
+{
+	this->is_enabled = is_enabled;
+	this->width = width > 0 ? width : 160;
+	this->threshold = threshold > 0 ? threshold : 25;
+	this->min_area = min_area >= 0 ? min_area : 0.002;
+	this->idle_interval = chrono::milliseconds(idle_interval_ms > 0 ? idle_interval_ms : 0);
+	this->learning_rate = learning_rate > 0 && learning_rate <= 1 ? learning_rate : 0.05;
+
+	reset();
+}
+
+void MotionGate::reset()
+{
+	background.release();
+	last_inferred = chrono::steady_clock::time_point();
+	passed.store(0, memory_order_relaxed);
+	forced.store(0, memory_order_relaxed);
+	skipped.store(0, memory_order_relaxed);
+}
+
+void MotionGate::set_crop(bool is_crop, double padding, double max_area)
+{
+	this->is_crop = is_crop;
+	crop_padding = padding >= 0 ? padding : 0.25;
+	crop_max_area = max_area > 0 && max_area <= 1 ? max_area : 0.6;
+}
+
+bool MotionGate::get_crop(const std::vector<cv::Rect>& regions, const cv::Size& frame_size, cv::Rect& crop) const
+{
+	if (!is_enabled || !is_crop || regions.empty())
+		return false;
+
+	Rect changed = regions.front();
+	for (auto& region : regions) {
+		changed |= region;
+	}
+
+	int pad_x = static_cast<int>(changed.width * crop_padding);
+	int pad_y = static_cast<int>(changed.height * crop_padding);
+	crop = Rect(changed.x - pad_x, changed.y - pad_y, changed.width + 2 * pad_x, changed.height + 2 * pad_y) & Rect(Point(0, 0), frame_size);
+
+	return !crop.empty() && crop.area() < crop_max_area * frame_size.area();
+}
+
+bool MotionGate::check(const cv::Mat& frame, std::vector<cv::Rect>& regions)
+{
+	regions.clear();
+
+	if (!is_enabled || frame.empty())
+		return true;
+
+	int height = max(1, frame.rows * width / max(1, frame.cols));
+	resize(frame, small, Size(width, height), 0, 0, INTER_AREA);
+	if (small.channels() == 3)
+		cvtColor(small, gray, COLOR_BGR2GRAY);
+	else if (small.channels() == 4)
+		cvtColor(small, gray, COLOR_BGRA2GRAY);
+	else
+		gray = small;
+	GaussianBlur(gray, gray, Size(5, 5), 0);
+
+	auto now = chrono::steady_clock::now();
+	if (background.empty() || background.size() != gray.size()) {
+		gray.convertTo(background, CV_32F);
+		last_inferred = now;
+		passed.fetch_add(1, memory_order_relaxed);
+		return true;
+	}
+
+	background.convertTo(background_u8, CV_8U);
+	absdiff(gray, background_u8, diff);
+	cv::threshold(diff, mask, threshold, 255, THRESH_BINARY);
+	accumulateWeighted(gray, background, learning_rate);
+
+	double changed = static_cast<double>(countNonZero(mask)) / mask.total();
+	if (changed > 0 && changed >= min_area) {
+		double sx = static_cast<double>(frame.cols) / gray.cols;
+		double sy = static_cast<double>(frame.rows) / gray.rows;
+
+		findContours(mask, contours, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+		for (auto& contour : contours) {
+			Rect r = boundingRect(contour);
+			Rect scaled(static_cast<int>(r.x * sx), static_cast<int>(r.y * sy), static_cast<int>(ceil(r.width * sx)), static_cast<int>(ceil(r.height * sy)));
+			regions.push_back(scaled & Rect(0, 0, frame.cols, frame.rows));
+		}
+
+		last_inferred = now;
+		passed.fetch_add(1, memory_order_relaxed);
+		return true;
+	}
+
+	if (idle_interval.count() > 0 && now - last_inferred >= idle_interval) {
+		last_inferred = now;
+		forced.fetch_add(1, memory_order_relaxed);
+		return true;
+	}
+
+	skipped.fetch_add(1, memory_order_relaxed);
+	return false;
+}
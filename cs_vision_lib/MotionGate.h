@@ -0,0 +1,85 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+namespace cs
+{
+	/*
+	* Cheap change detector executed before the detectors. The frame is downscaled to a small gray image and
+	* compared with a running average background. Frames where the changed part is under min_area are skipped,
+	* one frame per idle_interval still goes through, so static scenes are inferred at a low rate.
+	*/
+	class MotionGate
+	{
+	public:
+		MotionGate() {};
+		virtual ~MotionGate() {};
+
+		// width - width of the compared image, threshold - per pixel gray delta, min_area - changed part of the frame (0..1)
+		// idle_interval_ms - max time between inferred frames of a static scene, 0 - static frames are never inferred
+		void init(bool is_enabled, int width, int threshold, double min_area, int idle_interval_ms, double learning_rate);
+		void reset();
+
+		// true - the frame has to be inferred. regions - bounding boxes of the changed areas in frame coordinates,
+		// empty when the whole frame has to be processed
+		bool check(const cv::Mat& frame, std::vector<cv::Rect>& regions);
+
+		// root detectors get the bounding box of the changed areas instead of the frame. padding - part of the box size
+		// added on every side, max_area - part of the frame (0..1) above which the whole frame is inferred
+		void set_crop(bool is_crop, double padding, double max_area);
+		// false - the whole frame has to be inferred
+		bool get_crop(const std::vector<cv::Rect>& regions, const cv::Size& frame_size, cv::Rect& crop) const;
+
+		bool get_is_enabled() const { return is_enabled; };
+		// counters are written by the inference stage and read by the publish stage
+		uint64_t get_passed() const { return passed.load(std::memory_order_relaxed); };		// changed frames
+		uint64_t get_forced() const { return forced.load(std::memory_order_relaxed); };		// static frames inferred by idle_interval
+		uint64_t get_skipped() const { return skipped.load(std::memory_order_relaxed); };	// inference saved
+	private:
+		bool is_enabled = false;
+		int width = 160;
+		int threshold = 25;
+		double min_area = 0.002;
+		std::chrono::milliseconds idle_interval = std::chrono::milliseconds(1000);
+		double learning_rate = 0.05;
+		bool is_crop = false;
+		double crop_padding = 0.25;
+		double crop_max_area = 0.6;
+
+		cv::Mat small, gray, background, background_u8, diff, mask;
+		std::vector<std::vector<cv::Point>> contours;
+		std::chrono::steady_clock::time_point last_inferred;
+
+		std::atomic<uint64_t> passed = 0;
+		std::atomic<uint64_t> forced = 0;
+		std::atomic<uint64_t> skipped = 0;
+	};
+}
@@ -84,6 +84,9 @@ int OpenCVCamera::open(camera_settings* settings, void* param)
 	if (settings == nullptr)
 		return 0;
 
+	is_use_grab_thread = settings->additional.get<bool>("is_grab_thread", false);
+	grab_timeout_ms = settings->additional.get<int>("grab_timeout_ms", grab_timeout_ms);
+
 	auto device = settings->device;
 	if (std::holds_alternative<int>(device)) {
 		return open(std::get<int>(device), settings->frame_width, settings->frame_height);
@@ -119,7 +122,10 @@ int OpenCVCamera::open(const char* name)
 		if (capture->isOpened()) {
 			cout << "Video from: " << name << endl;
 			source_is_file = file_exists(name);
-			return info();
+			int ret = info();
+			if (ret)
+				start_grab_thread();
+			return ret;
 		}
 	}
 	catch (...) {
@@ -153,7 +159,10 @@ int OpenCVCamera::open(int id, const int frame_width, const int frame_height)
 
 		if (capture->isOpened()) {
 			cout << "Video from device: #" << id << endl;
-			return info();
+			int ret = info();
+			if (ret)
+				start_grab_thread();
+			return ret;
 		}
 		else
 			cout << "Can not open camera #" << id << endl;
@@ -169,6 +178,8 @@ int OpenCVCamera::close()
 {
 	int ret = 0;
 
+	stop_grab_thread();
+
 	if (capture != nullptr) {
 		if (capture->isOpened())
 			capture->release();
@@ -201,7 +212,28 @@ int OpenCVCamera::get_frame(cv::Mat& frame_out, bool convert_to_gray)
 {
 	int ret = 1;
 
+	if (grab_thread != nullptr) {
+		if (grab_channel.take(frame_out, std::chrono::milliseconds(grab_timeout_ms))) {
+			if (convert_to_gray)
+				cvtColor(frame_out, frame_out, COLOR_BGR2GRAY);
+
+			return 1;
+		}
+
+		frame_out.release();
+		if (!is_grabbing)
+			open(device);
+
+		return 0;
+	}
+
 	if (capture && capture->isOpened()) {
+		if (frame_pool != nullptr && !frame_pool->acquire(frame_out, height, width, CV_8UC3)) {
+			// pool is full, frame is dropped but the source is still drained
+			capture->grab();
+			return 0;
+		}
+
 		*capture >> frame_out;
 
 		if (!frame_out.empty()) {
@@ -223,6 +255,59 @@ int OpenCVCamera::get_frame(cv::Mat& frame_out, bool convert_to_gray)
 	return ret;
 }
 
+// files are read frame by frame, only live sources are drained
+void OpenCVCamera::start_grab_thread()
+{
+	if (!is_use_grab_thread || source_is_file || grab_thread != nullptr || capture == nullptr)
+		return;
+
+	grab_channel.open();
+	is_grabbing = true;
+	grab_thread = new std::thread(&OpenCVCamera::grab_func, this);
+}
+
+void OpenCVCamera::stop_grab_thread()
+{
+	if (grab_thread == nullptr)
+		return;
+
+	is_grabbing = false;
+	grab_channel.close();
+
+	if (grab_thread->joinable())
+		grab_thread->join();
+
+	delete grab_thread;
+	grab_thread = nullptr;
+}
+
+void OpenCVCamera::grab_func()
+{
+	cv::Mat grabbed;
+
+	while (is_grabbing) {
+		if (frame_pool != nullptr && !frame_pool->acquire(grabbed, height, width, CV_8UC3)) {
+			if (!capture->grab())
+				break;
+
+			grab_channel.skip();
+			continue;
+		}
+
+		if (!capture->grab() || !capture->retrieve(grabbed) || grabbed.empty()) {
+			cout << "Grab thread: stream is interrupted" << endl;
+			break;
+		}
+
+		grab_channel.put(grabbed);
+		// camera loop owns the buffer now, next retrieve gets a fresh one
+		grabbed.release();
+	}
+
+	is_grabbing = false;
+	grab_channel.close();
+}
+
 bool OpenCVCamera::is_opened()
 {
 	return capture->isOpened();
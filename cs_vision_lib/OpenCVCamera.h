@@ -25,7 +25,10 @@
 
 #include <string>
 #include <variant>
+#include <thread>
+#include <atomic>
 #include "ICamera.h"
+#include "FrameChannel.h"
 #include <opencv2/core.hpp>
 #include <opencv2/core/utility.hpp>
 #include <opencv2/imgproc.hpp>
@@ -70,11 +73,25 @@ namespace cs
 		virtual bool is_opened() override;
 
 		virtual void set_ready(bool val) override { ready_flag = true; }
+
+		// frames grabbed from the stream but replaced by a newer one before the camera loop took them
+		virtual uint64_t get_skipped_frames() override { return grab_channel.get_dropped(); }
 	private:
 		int fps = 0;
 		int width = 0;
 		int height = 0;
 		cv::Mat frame;
 		cv::VideoCapture* capture = NULL;
+
+		// latest frame wins: the grab thread drains the decoder, camera loop gets the newest frame only
+		bool is_use_grab_thread = false;
+		int grab_timeout_ms = 1000;
+		std::thread* grab_thread = nullptr;
+		std::atomic_bool is_grabbing = false;
+		FrameChannel<cv::Mat> grab_channel;
+
+		void start_grab_thread();
+		void stop_grab_thread();
+		void grab_func();
 	};
 }
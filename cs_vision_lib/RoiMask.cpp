@@ -0,0 +1,109 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "RoiMask.h"
+#include <opencv2/imgproc.hpp>
+
+using namespace cs;
+
+//******************************************************************************************
+void RoiMask::set_polygons(const std::vector<std::vector<cv::Point>>& zones)
+{
+	clear();
+
+	for (auto& zone : zones) {
+		if (zone.size() >= 3)
+			polygons.push_back(zone);
+	}
+}
+
+void RoiMask::clear()
+{
+	polygons.clear();
+	frame_size = cv::Size();
+	rect = cv::Rect();
+	mask.release();
+	is_rect = false;
+}
+
+void RoiMask::build(const cv::Size& size)
+{
+	frame_size = size;
+	rect = cv::Rect();
+	mask.release();
+	is_rect = false;
+
+	for (auto& zone : polygons) {
+		rect |= cv::boundingRect(zone);
+	}
+	rect &= cv::Rect(0, 0, size.width, size.height);
+	if (rect.empty())
+		return;
+
+	mask = cv::Mat::zeros(rect.size(), CV_8UC1);
+	cv::fillPoly(mask, polygons, cv::Scalar(255), cv::LINE_8, 0, -rect.tl());
+
+	is_rect = cv::countNonZero(mask) == rect.area();
+	if (is_rect)
+		mask.release();
+}
+
+bool RoiMask::apply(const cv::Mat& frame, cv::Mat& dst, cv::Point& offset, FramePool* pool)
+{
+	if (polygons.empty() || frame.empty())
+		return false;
+
+	if (frame.size() != frame_size)
+		build(frame.size());
+
+	if (rect.empty())
+		return false;
+
+	offset = rect.tl();
+	if (is_rect) {
+		dst = frame(rect);
+		return true;
+	}
+
+	if (pool == nullptr || !pool->acquire(dst, rect.size(), frame.type()))
+		dst.create(rect.size(), frame.type());
+
+	dst.setTo(cv::Scalar::all(0));
+	frame(rect).copyTo(dst, mask);
+
+	return true;
+}
+
+bool RoiMask::contains(const cv::Point2f& pt) const
+{
+	if (polygons.empty())
+		return true;
+
+	for (auto& zone : polygons) {
+		if (cv::pointPolygonTest(zone, pt, false) >= 0)
+			return true;
+	}
+
+	return false;
+}
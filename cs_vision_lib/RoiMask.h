@@ -0,0 +1,65 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include "FramePool.h"
+
+namespace cs
+{
+	/*
+	* Polygon zones of interest of a camera or a detector in detect frame coordinates. Detectors get only the bounding
+	* rectangle of the zones, pixels outside of the polygons are filled with black, so the cost of preprocessing and inference
+	* goes down with the removed area. Results are mapped back by the crop offset (original_x/original_y).
+	*/
+	class RoiMask
+	{
+	public:
+		RoiMask() {};
+		virtual ~RoiMask() {};
+
+		void set_polygons(const std::vector<std::vector<cv::Point>>& zones);
+		void clear();
+
+		// dst - crop of the zones (a view of frame when the zones are one rectangle), offset - its top left corner in the frame.
+		// returns false when the zones are outside of the frame
+		bool apply(const cv::Mat& frame, cv::Mat& dst, cv::Point& offset, FramePool* pool = nullptr);
+		bool contains(const cv::Point2f& pt) const;
+
+		bool get_is_enabled() const { return !polygons.empty(); };
+		const cv::Rect& get_rect() const { return rect; };
+	private:
+		void build(const cv::Size& size);
+
+		std::vector<std::vector<cv::Point>> polygons;
+
+		// rebuilt when the frame size changes
+		cv::Size frame_size;
+		cv::Rect rect;
+		cv::Mat mask;
+		bool is_rect = false; // zones cover the whole bounding rectangle, mask isn`t needed
+	};
+}
@@ -0,0 +1,181 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "TilePlanner.h"
+#include "IObjectDetector.h"
+#include <algorithm>
+
+using namespace cs;
+
+//******************************************************************************************
+void TilePlanner::init(int tile_width, int tile_height, double overlap, bool is_coarse_pass, double merge_iou, double merge_ios)
+{
+	this->tile_width = std::max(tile_width, 0);
+	this->tile_height = std::max(tile_height, 0);
+	this->overlap = std::clamp(overlap, 0.0, 0.9);
+	this->is_coarse_pass = is_coarse_pass;
+	this->merge_iou = merge_iou;
+	this->merge_ios = merge_ios;
+
+	image_size = cv::Size();
+	tiles.clear();
+
+	std::lock_guard<std::mutex> lock(durations_mutex);
+	durations_sum.clear();
+	frames_count = 0;
+}
+
+// start positions of the tiles along one axis
+static void plan_axis(int length, int tile, double overlap, std::vector<int>& starts)
+{
+	starts.clear();
+	if (length <= tile) {
+		starts.push_back(0);
+		return;
+	}
+
+	int step = std::max(1, static_cast<int>(tile * (1.0 - overlap)));
+	for (int pos = 0; ; pos += step) {
+		if (pos + tile >= length) {
+			starts.push_back(length - tile);
+			break;
+		}
+		starts.push_back(pos);
+	}
+}
+
+const std::vector<cv::Rect>& TilePlanner::plan(const cv::Size& size)
+{
+	if (size == image_size)
+		return tiles;
+
+	image_size = size;
+	tiles.clear();
+	if (!get_is_enabled() || size.empty())
+		return tiles;
+
+	std::vector<int> xs, ys;
+	plan_axis(size.width, tile_width, overlap, xs);
+	plan_axis(size.height, tile_height, overlap, ys);
+
+	for (int y : ys) {
+		for (int x : xs) {
+			tiles.emplace_back(cv::Rect(x, y, tile_width, tile_height) & cv::Rect(0, 0, size.width, size.height));
+		}
+	}
+
+	return tiles;
+}
+
+static cv::Rect2f frame_box(const DetectionItem* item)
+{
+	float scale = item->scale_factor > 1 ? static_cast<float>(item->scale_factor) : 1.0f;
+	return cv::Rect2f(item->box.x / scale + item->original_x, item->box.y / scale + item->original_y, item->box.width / scale, item->box.height / scale);
+}
+
+void TilePlanner::merge(std::vector<DetectionItem*>& items) const
+{
+	if (items.size() < 2)
+		return;
+
+	std::stable_sort(items.begin(), items.end(), [](DetectionItem* a, DetectionItem* b) { return a->score > b->score; });
+
+	std::vector<cv::Rect2f> boxes;
+	boxes.reserve(items.size());
+	for (auto& item : items) {
+		boxes.push_back(frame_box(item));
+	}
+
+	std::vector<bool> is_removed(items.size(), false);
+	for (size_t i = 0; i < items.size(); i++) {
+		if (is_removed[i])
+			continue;
+
+		bool is_joined = false;
+		for (size_t j = i + 1; j < items.size(); j++) {
+			if (is_removed[j] || items[j]->class_id != items[i]->class_id)
+				continue;
+
+			float inter = (boxes[i] & boxes[j]).area();
+			if (inter <= 0)
+				continue;
+
+			float area_i = boxes[i].area();
+			float area_j = boxes[j].area();
+			float iou = inter / (area_i + area_j - inter);
+			float ios = inter / std::min(area_i, area_j);
+
+			if (iou >= merge_iou) {
+				is_removed[j] = true;
+			}
+			else if (ios >= merge_ios) {
+				// parts of one object found by the neighbour tiles
+				boxes[i] |= boxes[j];
+				is_removed[j] = true;
+				is_joined = true;
+			}
+		}
+
+		if (is_joined) {
+			float scale = items[i]->scale_factor > 1 ? static_cast<float>(items[i]->scale_factor) : 1.0f;
+			items[i]->box = cv::Rect2f((boxes[i].x - items[i]->original_x) * scale, (boxes[i].y - items[i]->original_y) * scale,
+				boxes[i].width * scale, boxes[i].height * scale);
+		}
+	}
+
+	size_t count = 0;
+	for (size_t i = 0; i < items.size(); i++) {
+		if (!is_removed[i])
+			items[count++] = items[i];
+	}
+	items.resize(count);
+}
+
+void TilePlanner::add_durations(const std::vector<double>& durations_ms)
+{
+	std::lock_guard<std::mutex> lock(durations_mutex);
+	if (durations_sum.size() != durations_ms.size()) {
+		durations_sum.assign(durations_ms.size(), 0);
+		frames_count = 0;
+	}
+
+	for (size_t i = 0; i < durations_ms.size(); i++) {
+		durations_sum[i] += durations_ms[i];
+	}
+	frames_count++;
+}
+
+std::vector<double> TilePlanner::get_mean_durations()
+{
+	std::lock_guard<std::mutex> lock(durations_mutex);
+	std::vector<double> res(durations_sum.size(), 0);
+	if (frames_count == 0)
+		return res;
+
+	for (size_t i = 0; i < durations_sum.size(); i++) {
+		res[i] = durations_sum[i] / frames_count;
+	}
+
+	return res;
+}
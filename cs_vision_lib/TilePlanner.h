@@ -0,0 +1,80 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+namespace cs
+{
+	class DetectionItem;
+
+	/*
+	* Tiled inference of high resolution frames. The image is split into overlapping tiles of the model`s scale,
+	* every tile is inferred as a separate image (batched when the detector supports it), optionally together with
+	* a coarse pass over the whole image. Objects cut by the tile seams are found by several tiles, merge() keeps
+	* one box per object.
+	*/
+	class TilePlanner
+	{
+	public:
+		TilePlanner() {};
+		virtual ~TilePlanner() {};
+
+		// tile_width/tile_height - 0 disables tiling, overlap - part of the tile shared with the neighbour (0..0.9)
+		// merge_iou - boxes of one class overlapping more are duplicates, merge_ios - intersection over the smaller box,
+		// boxes cut by a seam are joined into their union
+		void init(int tile_width, int tile_height, double overlap, bool is_coarse_pass, double merge_iou, double merge_ios);
+
+		// tiles of the image, the last tile of a row/column is shifted back to stay inside of the image
+		const std::vector<cv::Rect>& plan(const cv::Size& size);
+
+		// items - results of the tiles, boxes are compared in frame coordinates (original_x/original_y)
+		void merge(std::vector<DetectionItem*>& items) const;
+
+		// durations of the images of one frame in the order of plan(), coarse pass first
+		void add_durations(const std::vector<double>& durations_ms);
+		std::vector<double> get_mean_durations();
+
+		bool get_is_enabled() const { return tile_width > 0 && tile_height > 0; };
+		bool get_is_coarse_pass() const { return is_coarse_pass; };
+	private:
+		int tile_width = 0;
+		int tile_height = 0;
+		double overlap = 0.2;
+		bool is_coarse_pass = false;
+		double merge_iou = 0.5;
+		double merge_ios = 0.8;
+
+		cv::Size image_size;
+		std::vector<cv::Rect> tiles;
+
+		std::mutex durations_mutex;
+		std::vector<double> durations_sum;
+		uint64_t frames_count = 0;
+	};
+}
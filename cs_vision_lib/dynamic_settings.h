@@ -4,6 +4,8 @@
 #include <map>
 #include <variant>
 #include <list>
+#include <set>
+#include <type_traits>
 #include "JsonWrapper.h"
 #include "types.h"
 
@@ -85,6 +87,28 @@ namespace cs
 			return default_value;
 		}
 
+		// name=value of every setting in the name order, excluded settings are skipped
+		std::string get_signature(const std::set<std::string>& excluded = {}) const
+		{
+			std::string signature;
+			for (auto& [name, value] : settings) {
+				if (excluded.count(name) > 0)
+					continue;
+
+				signature += name + "=";
+				std::visit([&signature](auto&& v) {
+					using T = std::decay_t<decltype(v)>;
+					if constexpr (std::is_same_v<T, std::string>)
+						signature += v;
+					else
+						signature += std::to_string(v);
+				}, value);
+				signature += ";";
+			}
+
+			return signature;
+		}
+
 		int parse(rapidjson::Value& root);
 	private:
 		std::map<std::string, std::variant<int, std::string, float, double, bool>> settings;
@@ -51,6 +51,29 @@ int dynamic_settings::parse(rapidjson::Value& root)
 	return settings.size() > 0;
 }
 
+//******************************************************************************************
+// "roi": [ [[x, y], [x, y], [x, y], ...], ... ] - list of polygons
+static void parse_roi(rapidjson::Value& root, std::vector<std::vector<cv::Point>>& roi)
+{
+	roi.clear();
+	if (!root.HasMember("roi") || !root["roi"].IsArray())
+		return;
+
+	for (auto& zone : root["roi"].GetArray()) {
+		if (!zone.IsArray())
+			continue;
+
+		std::vector<cv::Point> polygon;
+		for (auto& pt : zone.GetArray()) {
+			if (pt.IsArray() && pt.Size() == 2 && pt[0].IsNumber() && pt[1].IsNumber())
+				polygon.emplace_back(cvRound(pt[0].GetDouble()), cvRound(pt[1].GetDouble()));
+		}
+
+		if (polygon.size() >= 3)
+			roi.push_back(polygon);
+	}
+}
+
 //******************************************************************************************
 detector_settings::detector_settings(detector_settings& settings)
 {
@@ -98,6 +121,7 @@ int detector_settings::parse(rapidjson::Value& root)
 	color = cv_string_to_color(json_get_string(root, "color", "0x00FFFFFF"));
 	//unsigned int x = std::stoul(str_color, nullptr, 16);
 	//color = cv::Scalar(x & 0x00FF0000, x & 0x0000FF00 >> 2, x & 0x000000FF);
+	parse_roi(root, roi);
 
 #ifdef __WITH_SCRIPT_LANG__
 	on_detect = json_get_string(root, "on_detect", on_detect.c_str());
@@ -151,6 +175,7 @@ int camera_settings::parse(rapidjson::Value& root)
 	frame_height = json_get_int(root, "frame_height", frame_height);
 	resize_x = json_get_int(root, "resize_x", resize_x);
 	resize_y = json_get_int(root, "resize_y", resize_y);
+	parse_roi(root, roi);
 	//is_show_mask = json_get_bool(root, "is_show_mask", is_show_mask);
 
 	mqtt = json_get_bool(root, "mqtt", mqtt);
@@ -255,6 +280,8 @@ int device_settings::parse(Document& root)
 		readonly_checker_dictionary = json_get_string(settings, "readonly_checker_dictionary", readonly_checker_dictionary.c_str());
 		secrets_dictionary = json_get_string(settings, "secrets_dictionary", secrets_dictionary.c_str());
 		is_create_backup = json_get_bool(root, "is_create_backup", is_create_backup);
+		inference_threads = json_get_int(settings, "inference_threads", inference_threads);
+		thread_budget_cores = json_get_int(settings, "thread_budget_cores", thread_budget_cores);
 
 		if (settings.HasMember("cameras")) {
 			if (settings["cameras"].IsArray()) {
@@ -73,6 +73,8 @@ namespace cs
 
 		cv::Scalar color = cv::Scalar(255, 255, 255);
 
+		std::vector<std::vector<cv::Point>> roi; // inference zones, empty - zones of the camera
+
 #ifdef __WITH_SCRIPT_LANG__
 		std::string on_detect = "";
 		bool execute_always = false;
@@ -111,6 +113,8 @@ namespace cs
 		int resize_y = 0;
 		//bool is_show_mask = false;
 
+		std::vector<std::vector<cv::Point>> roi; // inference zones in detect frame coordinates, empty - whole frame
+
 		bool mqtt = true; // to do: should be changed to false
 		std::string mqtt_client_name = "";
 		std::string mqtt_broker_ip = "";
@@ -182,6 +186,9 @@ namespace cs
 		std::string secrets_dictionary = "";
 		bool is_create_backup = true;
 
+		int inference_threads = 0; // shared inference pool size, 0 - one worker per core
+		int thread_budget_cores = 0; // cores shared by the backends` intra-op threads, 0 - all
+
 		http_server_settings* http_server = nullptr;
 	protected:
 		int parse(rapidjson::Document& root) override;
@@ -40,7 +40,9 @@ namespace cs
 		OBJECT_DETECTOR_MOT_BYTETRACK = 14,
 		OBJECT_DETECTOR_MOT_DEEPSORT = 15,
 		OBJECT_DETECTOR_OLLAMA_PROMPT = 16,
-		OBJECT_DETECTOR_RETINANET = 17
+		OBJECT_DETECTOR_RETINANET = 17,
+		OBJECT_DETECTOR_ONNXRUNTIME_YOLO = 18,
+		OBJECT_DETECTOR_CASCADE = 19
 	};
 
 	enum class ObjectDetectorEvent {
@@ -25,6 +25,8 @@
 #include <thread>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <set>
 #ifdef __LINUX__
 #include <signal.h>
 #endif
@@ -61,6 +63,11 @@
 #include "IObjectDetector.h"
 #include "MQTTClient.h"
 #include "DetectorEnvironment.h"
+#include "WorkStealingPool.h"
+#include "CrossCameraBatcher.h"
+#include "ModelRegistry.h"
+#include "ThreadBudget.h"
+#include "CascadeObjectDetector.h"
 #ifdef __WITH_VIDEO_STREAMER__
 #include "HTTPVideoStreamer.h"
 #ifdef __WITH_RTSP_STREAMER__
@@ -80,7 +87,7 @@ using namespace cv::cuda;
 #endif
 using namespace cs;
 
-void cpu_preprocessing(Mat& frame, camera_settings* set, Size& border_dims);
+void cpu_preprocessing(Mat& frame, FrameTransform& transform, Size& border_dims, FramePool* pool = nullptr);
 
 void create_video_streamer(DetectorEnvironment* environment, camera_settings* set, ICamera* capture)
 {
@@ -163,6 +170,13 @@ bool cleanup_detectors_environment(DetectorEnvironment* environment)
 	if (environment == nullptr)
 		return false;
 
+	// stages still reference detectors and the MQTT client, drain them first
+	environment->stream_channel.close();
+	if (environment->pipeline != nullptr) {
+		delete environment->pipeline;
+		environment->pipeline = nullptr;
+	}
+
 	if (environment->mqtt_client != nullptr) {
 		delete environment->mqtt_client;
 		environment->mqtt_client = nullptr;
@@ -189,6 +203,12 @@ bool cleanup_detectors_environment(DetectorEnvironment* environment)
 		environment->image_writer = nullptr;
 	}
 
+	environment->detector_graph.clear();
+	// late asynchronous calls still run virtual detect, they are waited before the derived parts are destroyed
+	for (auto& detector : environment->detectors) {
+		if (detector != nullptr)
+			detector->stop_async();
+	}
 	for (auto& detector : environment->detectors) {
 		if (detector != nullptr) {
 			//detector->cleanup();
@@ -197,9 +217,6 @@ bool cleanup_detectors_environment(DetectorEnvironment* environment)
 	}
 	environment->detectors.clear();
 	environment->detect_frame = nullptr;
-	environment->show_frame.release();
-	environment->is_can_show = false;
-	environment->detector_ready = false;
 	environment->original_size = Size(0, 0);
 
 	return true;
@@ -212,21 +229,29 @@ bool init_detectors_environment(DetectorEnvironment* environment, camera_setting
 
 	environment->camera_id = set->id;
 
-	environment->is_undistort = set->is_undistort;
-	if (environment->is_undistort && set->camera_matrix.size() == 9 && set->distortion_coefficients.size() == 4) {
-		cv::Mat K = (cv::Mat_<double>(3, 3)); 
+	cv::Mat K, D;
+	if (set->is_undistort && set->camera_matrix.size() == 9 && set->distortion_coefficients.size() == 4) {
+		K = (cv::Mat_<double>(3, 3)); 
 		memcpy(K.data, set->camera_matrix.data(), sizeof(double) * 9);
-		cv::Mat D = (cv::Mat_<double>(4, 1));
+		D = (cv::Mat_<double>(4, 1));
 		memcpy(D.data, set->distortion_coefficients.data(), sizeof(double) * 4);
+	}
 
-		cv::Mat R = cv::Mat::eye(3, 3, CV_64F); // Identity matrix for no rotation
-		cv::Mat newK = K.clone();               // Adjusted camera matrix (can modify focal length, etc.)
+	// undistort, flip and rotation are composed once, frames go through a single remap (or flip) in the preprocess stage
+	environment->frame_transform.set_bands(set->additional.get<int>("geometry_bands", 1));
+	environment->frame_transform.init(cv::Size(capture->get_width(), capture->get_height()), K, D, set->get_is_flip(), set->get_rotate_angle());
 
-		cv::fisheye::initUndistortRectifyMap(K, D, R, newK, cv::Size(capture->get_width(), capture->get_height()), CV_16SC2, environment->map1, environment->map2);
-	}
-	else {
-		environment->is_undistort = false;
-	}
+	environment->motion_gate.init(set->additional.get<bool>("motion_gate", false),
+		set->additional.get<int>("motion_gate_width", 160),
+		set->additional.get<int>("motion_gate_threshold", 25),
+		set->additional.get<int>("motion_gate_min_area_permille", 2) / 1000.0,
+		set->additional.get<int>("motion_gate_idle_interval_ms", 1000),
+		set->additional.get<int>("motion_gate_learning_percent", 5) / 100.0);
+	environment->motion_gate.set_crop(set->additional.get<bool>("motion_gate_crop", false),
+		set->additional.get<int>("motion_gate_crop_padding_percent", 25) / 100.0,
+		set->additional.get<int>("motion_gate_crop_max_percent", 60) / 100.0);
+
+	environment->roi.set_polygons(set->roi);
 
 	environment->is_sort_results = set->is_sort_results;
 	environment->mqtt = set->mqtt;
@@ -267,6 +292,8 @@ bool init_detectors_environment(DetectorEnvironment* environment, camera_setting
 			detector_env.input_tensor_name = detector->input_tensor_name;
 			detector_env.output_tensor_name = detector->output_tensor_name;
 			detector_env.is_use_gpu = detector->is_use_gpu;
+			detector_env.model_width = detector->model_width;
+			detector_env.model_height = detector->model_height;
 			detector_env.fps = capture->get_fps();
 			if (detector_env.fps <= 0) {
 				detector_env.fps = CAMERA_DEFAULT_MAX_FPS;
@@ -275,7 +302,34 @@ bool init_detectors_environment(DetectorEnvironment* environment, camera_setting
 			detector_env.param = nullptr;
 			detector_env.mqtt_wrapper = environment->mqtt_client;
 
-			_detector->init(detector_env);
+			// cameras with the same model share one instance, their images are inferred together
+			if (detector->additional.get<bool>("cross_camera_batching", false)) {
+				// settings read by the engine`s init come from the first camera, cameras with other settings get their own group
+				static const std::set<std::string> camera_settings = { "cross_camera_batching", "illustration_mode", "max_batch_size", "detect_timeout_ms",
+					"tile_width", "tile_height", "tile_overlap_percent", "tile_coarse_pass", "tile_merge_iou_percent", "tile_merge_ios_percent" };
+				std::string model = std::to_string(detector->kind) + ":" + detector->model_path;
+				std::string options = detector->labels_path + ":" + detector->rules_path + ":" + detector->input_tensor_name + ":" + detector->output_tensor_name + ":"
+					+ std::to_string(detector->model_width) + "x" + std::to_string(detector->model_height) + ":" + std::to_string(detector->is_use_gpu) + ":"
+					+ detector->additional.get_signature(camera_settings);
+				_detector->batch_group = CrossCameraBatcher::get_instance()->join(model, options, [detector, detector_env]() {
+					IObjectDetector* engine = create_detector(detector->kind);
+					if (engine != nullptr) {
+						object_detector_environment engine_env = detector_env;
+						engine_env.mqtt_wrapper = nullptr; // outlives the camera which created it
+						engine->init(engine_env);
+						if (engine->get_is_uses_detections()) {
+							delete engine;
+							engine = nullptr;
+						}
+					}
+					return engine;
+				}, detector->additional.get<int>("cross_camera_batch_size", 0), detector->additional.get<int>("cross_camera_batch_latency_ms", 5));
+			}
+
+			if (_detector->batch_group == nullptr)
+				_detector->init(detector_env);
+			else
+				_detector->init_batch_member(detector_env);
 
 			_detector->name = detector->name;
 			_detector->id = detector->id;
@@ -287,7 +341,17 @@ bool init_detectors_environment(DetectorEnvironment* environment, camera_setting
 			_detector->is_draw_detections = detector->is_draw_detections;
 			_detector->results_mapping_rule = detector->results_mapping_rule;
 			_detector->color = detector->color;
+			_detector->roi.set_polygons(detector->roi);
+			_detector->tiles.init(detector->additional.get<int>("tile_width", 0),
+				detector->additional.get<int>("tile_height", detector->additional.get<int>("tile_width", 0)),
+				detector->additional.get<int>("tile_overlap_percent", 20) / 100.0,
+				detector->additional.get<bool>("tile_coarse_pass", false),
+				detector->additional.get<int>("tile_merge_iou_percent", 50) / 100.0,
+				detector->additional.get<int>("tile_merge_ios_percent", 80) / 100.0);
 			_detector->illustration_mode = detector->additional.get<int>("illustration_mode", 0);
+			// crops and tiles of this camera per detect_batch call, cameras sharing a model use cross_camera_batch_size
+			_detector->max_batch_size = detector->additional.get<int>("max_batch_size", 0);
+			_detector->detect_timeout_ms = detector->additional.get<int>("detect_timeout_ms", 0);
 #ifdef __WITH_SCRIPT_LANG__
 			_detector->on_detect = detector->on_detect;
 			_detector->execute_always = detector->execute_always;
@@ -316,10 +380,19 @@ bool init_detectors_environment(DetectorEnvironment* environment, camera_setting
 
 	environment->image_writer = new SampleImageWriter("sr_", ".jpg");
 
+	if (!environment->detector_graph.build(environment->detectors))
+		cout << "Detectors dependencies have a cycle, detectors will be executed sequentially" << endl;
+	else
+		cout << "Detectors graph levels: " << environment->detector_graph.get_levels().size() << " max parallel detectors: " << environment->detector_graph.get_max_width() << endl;
+
+	// memory and load time of the models loaded so far, shared ones are counted once
+	ModelRegistry::get_instance()->print_stats();
+	ThreadBudget::get_instance()->print_stats();
+
 	return 1; // environment->detectors.size();
 }
 
-void send_results_thread(DetectorEnvironment* env, list<DetectionItem*>& detections)
+void send_results_thread(DetectorEnvironment* env, DetectionSpan detections)
 {
 	if (env->mqtt_client == nullptr)
 		return;
@@ -327,7 +400,7 @@ void send_results_thread(DetectorEnvironment* env, list<DetectionItem*>& detecti
 	env->mqtt_client->send_detection(env->camera_id.c_str(), env->mqtt_detection_topic.c_str(), detections, env->field_aliases);
 }
 
-void draw_detections(DetectorEnvironment* env, cv::Mat* detect_frame, list<DetectionItem*>& detections)
+void draw_detections(DetectorEnvironment* env, cv::Mat* detect_frame, DetectionSpan detections)
 {
 	if (detect_frame == nullptr || env == nullptr)
 		return;
@@ -342,29 +415,20 @@ void draw_detections(DetectorEnvironment* env, cv::Mat* detect_frame, list<Detec
 	}
 }
 
+// image header shares the frame`s data, crops are ROIs without copying
 class detecting_image {
 public:
-	detecting_image(Mat* img, bool is_del_img, int x, int y, int id, int scale)
+	detecting_image(const Mat& img, int x, int y, int id, int scale)
 	{
 		predecessor_id = id;
 		image = img;
-		is_delete_img = is_del_img;
 		original_x = x;
 		original_y = y;
 		scale_factor = scale;
 	}
 
-	virtual ~detecting_image()
-	{
-		if (image != nullptr && is_delete_img) {
-			delete image;
-			image = nullptr;
-		}
-	}
-
 	int predecessor_id = -1;
-	Mat* image = nullptr;
-	bool is_delete_img = false;
+	Mat image;
 
 	int original_x = 0;
 	int original_y = 0;
@@ -380,23 +444,21 @@ void stream_thread_func(DetectorEnvironment* env)
 	if (env->video_stream_channel.length() == 0 || env->video_streamer == nullptr)
 		return;
 
-	while (true) {
-		if (!env->is_can_show && !env->show_frame.empty()) {
-			env->video_streamer->show(env->show_frame, env->video_stream_channel.c_str());
-			env->is_can_show = true;
-		}
+	cv::Mat frame;
+	while (env->stream_channel.take(frame)) {
+		env->video_streamer->show(frame, env->video_stream_channel.c_str());
+		frame.release();
 	}
 #endif
 }
 
-inline void draw_frame_title(cv::Mat* frame, DetectorEnvironment* env)
+inline void draw_frame_title(cv::Mat* frame, const std::string& title)
 {
 	cv::Point topLeft(50, 50);
 	cv::Point bottomRight(frame->cols - 50, frame->rows - 50);
 	cv::Scalar frameColor(0, 0, 0);
 	int thickness = 2;
 
-	std::string title = env->frame_title;
 	//title = title + " fps: " + std::to_string(env->fps.get_fps());
 
 	int fontFace = cv::FONT_HERSHEY_SIMPLEX;
@@ -435,26 +497,37 @@ inline void draw_frame_title(cv::Mat* frame, DetectorEnvironment* env)
 
 void stream_frame(cv::Mat* frame, DetectorEnvironment* env)
 {
-	if (env->is_can_show) {
-		frame->copyTo(env->show_frame);
-		if (!env->frame_title.empty() || env->draw_fps)
-			draw_frame_title(&env->show_frame, env);
-		env->is_can_show = false;
+	// streamer has not picked up the previous frame yet, don't waste a copy
+	if (env->stream_channel.is_pending()) {
+		env->stream_channel.skip();
+		return;
+	}
+
+	cv::Mat show_frame;
+	if (!env->frame_pool.acquire(show_frame, frame->size(), frame->type())) {
+		env->stream_channel.skip();
+		return;
 	}
+	frame->copyTo(show_frame);
+	std::string title = env->get_frame_title();
+	if (!title.empty() || env->draw_fps)
+		draw_frame_title(&show_frame, title);
+
+	env->stream_channel.put(show_frame);
 }
 
 #ifdef __WITH_SCRIPT_LANG__
 #ifdef __HAS_CUDA__
-void execute_script(DetectorEnvironment* env, cv::cuda::GpuMat* detect_frame, SCRIPT_EXECUTE_MODE mode, bool is_always, const char* script_name, std::list<DetectionItem*>* detections)
+void execute_script(DetectorEnvironment* env, cv::cuda::GpuMat* detect_frame, SCRIPT_EXECUTE_MODE mode, bool is_always, const char* script_name, DetectionSpan detections)
 #else
-void execute_script(DetectorEnvironment* env, cv::Mat* detect_frame, SCRIPT_EXECUTE_MODE mode, bool is_always, const char* script_name, std::list<DetectionItem*>* detections)
+void execute_script(DetectorEnvironment* env, cv::Mat* detect_frame, SCRIPT_EXECUTE_MODE mode, bool is_always, const char* script_name, DetectionSpan detections)
 #endif
 {
-	if (env == nullptr || script_name == nullptr || detections == nullptr || detect_frame == nullptr)
+	if (env == nullptr || script_name == nullptr || detect_frame == nullptr)
 		return;
 
 	if (env->script != nullptr) {
-		if (mode != SCRIPT_EXECUTE_MODE::SCRIPT_EXECUTE_MODE_NONE && (detections->size() > 0 || is_always)) {
+		if (mode != SCRIPT_EXECUTE_MODE::SCRIPT_EXECUTE_MODE_NONE && (detections.size() > 0 || is_always)) {
 			if (!env->script->execute_script(script_name, detections, detect_frame)) {
 
 			}
@@ -463,93 +536,344 @@ void execute_script(DetectorEnvironment* env, cv::Mat* detect_frame, SCRIPT_EXEC
 }
 #endif
 
-void detect_func(DetectorEnvironment* env)
+void add_node_detection(DetectorEnvironment* env, FrameContext* ctx, DetectorNode* node, const detecting_image& img, DetectionItem* d)
 {
-	if (env == nullptr)
+	IObjectDetector* detector = node->detector;
+	DetectionItem* detection_item = nullptr;
+	{
+		lock_guard<mutex> lock(ctx->arena_mutex);
+		detection_item = ctx->arena.create(d);
+	}
+
+	detection_item->predecessor_detector_id = detector->predecessor_id;
+	detection_item->predecessor_class = detector->predecessor_class;
+	detection_item->predecessor_id = img.predecessor_id;
+
+	detection_item->original_x = img.original_x;
+	detection_item->original_y = img.original_y;
+
+	detection_item->is_draw = detector->is_draw_detections;
+	detection_item->frame_w = env->detect_frame->cols;
+	detection_item->frame_h = env->detect_frame->rows;
+	detection_item->mapping_rule = static_cast<int16_t>(detector->results_mapping_rule);
+	detection_item->scale_factor = static_cast<int16_t>(img.scale_factor);
+	detection_item->is_send_result = detector->is_send_results;
+	detection_item->batch_index = -1;
+
+	node->results.push_back(detection_item);
+}
+
+/*
+* Detectors with a deadline run on their own thread, the node waits for them until the deadline of the frame.
+* A late detector leaves the frame without its results, its call goes on in the background and the detector
+* is skipped by the next frames until the call ends.
+*/
+void detect_node_async(DetectorEnvironment* env, FrameContext* ctx, DetectorNode* node, vector<detecting_image>& images,
+	const vector<DetectionItem*>& consumed, int& id, vector<double>& durations)
+{
+	IObjectDetector* detector = node->detector;
+	if (detector->get_is_async_busy()) {
+		detector->add_busy_skip();
 		return;
+	}
 
-	std::list<DetectionItem*> detections;
+	// results of the previous detectors belong to the frame context, a late call can outlive it
+	vector<DetectionItem> inputs;
+	inputs.reserve(consumed.size());
+	for (auto& d : consumed) {
+		inputs.push_back(*d);
+	}
+
+	auto deadline = chrono::steady_clock::now() + chrono::milliseconds(detector->detect_timeout_ms);
+	for (size_t i = 0; i < images.size(); i++) {
+		auto begin = chrono::steady_clock::now();
+		auto future = detector->detect_async(images[i].image, id, inputs);
+		if (future.wait_until(deadline) != future_status::ready) {
+			detector->add_timeout();
+			node->results.clear();
+			return;
+		}
+
+		try {
+			detect_result result = future.get();
+			if (result.ret == 1) {
+				for (auto& d : result.detections) {
+					add_node_detection(env, ctx, node, images[i], &d);
+				}
+			}
+			id += result.ids_count;
+		}
+		catch (const std::exception& ex) {
+			cout << "[Detector] " << detector->name << " detect failed: " << ex.what() << endl;
+		}
+
+		if (!durations.empty())
+			durations[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+	}
+}
+
+void detect_node(DetectorEnvironment* env, FrameContext* ctx, DetectorNode* node)
+{
+	IObjectDetector* detector = node->detector;
 	int id = 0;
 	int scale_factor = 1;
 
-	for (auto& detector : env->detectors) {
-		list<detecting_image*> images;
-		detecting_image* di = nullptr;
-		scale_factor = 1;
+	if (node->is_orphan) {
+		node->ids_count = 0;
+		return;
+	}
 
-		if (detector->predecessor_id < 0 || detector->predecessor_class < 0) {
-			di = new detecting_image(env->detect_frame, false, 0, 0, -1, 1);
-			images.push_back(di);
+	vector<detecting_image> images;
+
+	if (node->parent < 0) {
+		Mat root;
+		Point offset(0, 0);
+		// zones outside of the frame leave the detector without an image
+		if (detector->roi.get_is_enabled()) {
+			if (!detector->roi.apply(*env->detect_frame, root, offset, &env->frame_pool))
+				root.release();
 		}
-		else {
-			auto pred_detector = env->get_detector(detector->predecessor_id);
-			if (pred_detector != nullptr) {
-				for (auto& item : pred_detector->last_detections) {
-					if (item->class_id == detector->predecessor_class) {
+		else if (env->roi.get_is_enabled()) {
+			root = ctx->roi_frame;
+			offset = ctx->roi_offset;
+		}
+		else
+			root = *env->detect_frame;
+
+		// changed areas found by the motion gate narrow the image, a zone without changes leaves the detector without it
+		Rect motion;
+		if (!root.empty() && env->motion_gate.get_crop(ctx->motion_regions, env->detect_frame->size(), motion)) {
+			Rect local = Rect(motion.x - offset.x, motion.y - offset.y, motion.width, motion.height) & Rect(0, 0, root.cols, root.rows);
+			if (local.empty())
+				root.release();
+			else {
+				root = root(local);
+				offset += local.tl();
+			}
+		}
+
+		if (!root.empty()) {
+			if (detector->tiles.get_is_enabled()) {
+				auto& tiles = detector->tiles.plan(root.size());
+				images.reserve(tiles.size() + 1);
+				if (detector->tiles.get_is_coarse_pass() && tiles.size() > 1)
+					images.emplace_back(root, offset.x, offset.y, -1, 1);
+				for (auto& tile : tiles) {
+					images.emplace_back(root(tile), offset.x + tile.x, offset.y + tile.y, -1, 1);
+				}
+			}
+			else
+				images.emplace_back(root, offset.x, offset.y, -1, 1);
+		}
+	}
+	else {
+		// results of the predecessor are in the coordinates of its input image, crops are taken from the frame
+		Rect frame_rect(0, 0, env->detect_frame->cols, env->detect_frame->rows);
+		auto& pred_results = env->detector_graph.get_nodes()[node->parent]->results;
+		images.reserve(pred_results.size());
+		for (auto& item : pred_results) {
+			if (item->class_id == detector->predecessor_class) {
+				float pred_scale = item->scale_factor > 1 ? static_cast<float>(item->scale_factor) : 1.0f;
+				Rect2f box(item->box.x / pred_scale + item->original_x, item->box.y / pred_scale + item->original_y,
+					item->box.width / pred_scale, item->box.height / pred_scale);
+				if (detector->roi.get_is_enabled() && !detector->roi.contains((box.tl() + box.br()) * 0.5f))
+					continue;
+
+				Rect crop = Rect(box) & frame_rect;
+				if (crop.empty())
+					continue;
+
+				Mat img;
+				if (env->super_resolution != nullptr) {
 #ifdef __HAS_CUDA__
-						Mat* img = nullptr;
-						if (env->super_resolution != nullptr) {
-							img = new Mat();
-							Mat src, dst;
-							(*env->detect_frame)(item->box).copyTo(src);
-							env->super_resolution->upsample(src, dst);
-							dst.copyTo(*img); //  ->upload(dst);
-							scale_factor = detector->scale_factor;
-						}
-						else
-							img = new Mat((*env->detect_frame)(item->box));
+					Mat src, dst;
+					(*env->detect_frame)(crop).copyTo(src);
+					{
+						lock_guard<mutex> lock(env->super_resolution_mutex);
+						env->super_resolution->upsample(src, dst);
+					}
+					img = dst; //  ->upload(dst);
 #else
-						Mat* img = nullptr;
-						if (env->super_resolution != nullptr) {
-							img = new Mat();
-							env->super_resolution->upsample((*(env->detect_frame))(item->box), *img);
-							scale_factor = detector->scale_factor;
-						}
-						else
-							img = new Mat((*(env->detect_frame))(item->box));
+					lock_guard<mutex> lock(env->super_resolution_mutex);
+					env->super_resolution->upsample((*(env->detect_frame))(crop), img);
 #endif
-						di = new detecting_image(img, true, item->box.x, item->box.y, item->id, scale_factor); 
-
-						images.push_back(di);
-					}
+					scale_factor = detector->scale_factor;
 				}
+				else
+					img = (*(env->detect_frame))(crop);
+
+				if (!img.empty())
+					images.emplace_back(img, crop.x, crop.y, item->id, scale_factor);
 			}
 		}
+	}
+
+	// trackers consume results of every detector listed before them, all of them are on the previous levels
+	vector<DetectionItem*> consumed;
+	if (detector->get_is_uses_detections()) {
+		auto& nodes = env->detector_graph.get_nodes();
+		for (int i = 0; i < node->index; i++) {
+			consumed.insert(consumed.end(), nodes[i]->results.begin(), nodes[i]->results.end());
+		}
+	}
+
+	// crops of the predecessor are sent by max_batch_size, detectors without batching get them one by one
+	size_t batch_size = static_cast<size_t>(max(detector->get_model_batch_size(), 1));
+	if (detector->max_batch_size > 0)
+		batch_size = min(batch_size, static_cast<size_t>(detector->max_batch_size));
 
+	bool is_tiled = node->parent < 0 && detector->tiles.get_is_enabled();
+	vector<double> durations;
+	if (is_tiled)
+		durations.resize(images.size(), 0);
+
+	vector<Mat*> batch;
+	size_t pos = 0;
+
+	if (detector->batch_group != nullptr && !images.empty()) {
 		for (auto& img : images) {
-			if (img != nullptr && img->image != nullptr && !img->image->empty()) {
-				if (detector->detect(img->image, id, false, &detections) == 1) {
-					for (auto& d : detector->last_detections) {
-						DetectionItem* detection_item = new DetectionItem(d);
+			batch.push_back(&img.image);
+		}
+
+		auto begin = chrono::steady_clock::now();
+		// items of the shared engine carry its identity, the copies get the identity and the rules of the camera`s detector
+		detector->batch_group->infer(batch, [env, ctx, node, &images, &id](size_t index, DetectionItem* d) {
+			add_node_detection(env, ctx, node, images[index], d);
+			DetectionItem* item = node->results.back();
+			if (!node->detector->apply_batch_member(item)) {
+				node->results.pop_back();
+				return;
+			}
+			item->id = id++;
+		});
+
+		if (is_tiled) {
+			double duration = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count() / images.size();
+			fill(durations.begin(), durations.end(), duration);
+		}
+		pos = images.size();
+	}
+
+	if (detector->detect_timeout_ms > 0 && pos < images.size()) {
+		detect_node_async(env, ctx, node, images, consumed, id, durations);
+		pos = images.size();
+	}
+
+	while (pos < images.size()) {
+		size_t count = min(batch_size, images.size() - pos);
 
-						detection_item->predecessor_detector_id = detector->predecessor_id;
-						detection_item->predecessor_class = detector->predecessor_class;
-						detection_item->predecessor_id = img->predecessor_id;
+		bool is_batched = false;
+		if (count > 1) {
+			batch.clear();
+			for (size_t i = 0; i < count; i++) {
+				batch.push_back(&images[pos + i].image);
+			}
 
-						detection_item->original_x = img->original_x;
-						detection_item->original_y = img->original_y;
+			auto begin = chrono::steady_clock::now();
+			if (detector->detect_batch(batch, id, false) == 1) {
+				is_batched = true;
+				for (auto& d : detector->last_detections) {
+					if (d->batch_index >= 0 && d->batch_index < static_cast<int>(count))
+						add_node_detection(env, ctx, node, images[pos + d->batch_index], d);
+				}
 
-						detection_item->is_draw = detector->is_draw_detections;
-						detection_item->frame_w = env->detect_frame->cols;
-						detection_item->frame_h = env->detect_frame->rows;
-						detection_item->mapping_rule = detector->results_mapping_rule;
-						detection_item->scale_factor = img->scale_factor;
-						detection_item->is_send_result = detector->is_send_results;
+				if (is_tiled) {
+					double duration = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count() / count;
+					for (size_t i = 0; i < count; i++) {
+						durations[pos + i] = duration;
+					}
+				}
+			}
+			else
+				batch_size = 1;
+		}
 
-						detections.push_back(detection_item);
+		if (!is_batched) {
+			for (size_t i = 0; i < count; i++) {
+				auto begin = chrono::steady_clock::now();
+				if (detector->detect(&images[pos + i].image, id, false, consumed) == 1) {
+					for (auto& d : detector->last_detections) {
+						add_node_detection(env, ctx, node, images[pos + i], d);
 					}
 				}
+
+				if (is_tiled)
+					durations[pos + i] = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
 			}
 		}
 
+		pos += count;
+	}
+
+	// objects on the seams are found by several tiles (and by the coarse pass)
+	if (is_tiled) {
+		detector->tiles.merge(node->results);
+		detector->tiles.add_durations(durations);
+	}
+
 #ifdef __WITH_SCRIPT_LANG__
-		//execute_script(env, &env->detect_frame, detector->execute_mode, detector->execute_always, detector->on_detect.c_str(), &detector->last_detections);
+	//execute_script(env, &env->detect_frame, detector->execute_mode, detector->execute_always, detector->on_detect.c_str(), detector->last_detections);
 #endif
 
-		if (detector->predecessor_id >= 0 && detector->predecessor_class >= 0)
-			clear<detecting_image, std::list>(images);
+	node->ids_count = id;
+}
+
+/*
+* Every node numbers its results from 0. Results are appended in the detectors list order and ids are
+* shifted by the count of ids used by the previous nodes, so numbering doesn`t depend on the execution order.
+*/
+void merge_detections(DetectorEnvironment* env, vector<DetectionItem*>& detections)
+{
+	auto& nodes = env->detector_graph.get_nodes();
+
+	vector<int> offsets(nodes.size(), 0);
+	int offset = 0;
+	for (auto& node : nodes) {
+		offsets[node->index] = offset;
+		offset += node->ids_count;
 	}
 
+	for (auto& node : nodes) {
+		for (auto& d : node->results) {
+			d->id += offsets[node->index];
+			if (node->parent >= 0 && d->predecessor_id >= 0)
+				d->predecessor_id += offsets[node->parent];
+		}
+
+		detections.insert(detections.end(), node->results.begin(), node->results.end());
+		node->results.clear();
+		node->ids_count = 0;
+	}
+}
+
+void detect_func(DetectorEnvironment* env, FrameContext* ctx)
+{
+	if (env == nullptr || ctx == nullptr)
+		return;
+
+	env->detect_frame = &ctx->frame;
+
+	std::vector<DetectionItem*>& detections = ctx->detections;
+
+	if (env->roi.get_is_enabled())
+		env->roi.apply(ctx->frame, ctx->roi_frame, ctx->roi_offset, &env->frame_pool);
+
+	WorkStealingPool* pool = WorkStealingPool::get_instance();
+	for (auto& level : env->detector_graph.get_levels()) {
+		if (level.size() == 1) {
+			detect_node(env, ctx, level.front());
+			continue;
+		}
+
+		JobGroup group;
+		for (auto& node : level) {
+			pool->submit([env, ctx, node]() { detect_node(env, ctx, node); }, &group);
+		}
+		pool->wait(group);
+	}
+
+	merge_detections(env, detections);
+
 	for (auto& d : detections) {
 		int scale_factor = 1;
 		if (d->scale_factor > 1)
@@ -561,12 +885,12 @@ void detect_func(DetectorEnvironment* env)
 		d->box.height = d->box.height / scale_factor;
 
 		if (d->kind == ObjectDetectorKind::OBJECT_DETECTOR_QWEN && d->box.x < 0 && d->box.y < 0) {
-			env->frame_title = d->label;
+			env->set_frame_title(d->get_label());
 		}
 	}
 
 #ifdef __WITH_SCRIPT_LANG__
-	//execute_script(env, &env->detect_frame, env->execute_mode, env->execute_always, env->on_postprocess.c_str(), &detections);
+	//execute_script(env, &env->detect_frame, env->execute_mode, env->execute_always, env->on_postprocess.c_str(), detections);
 #endif
 
 #ifdef _DEBUG_
@@ -575,36 +899,173 @@ void detect_func(DetectorEnvironment* env)
 	}
 #endif
 
+	ctx->roi_frame.release();
+	env->detect_frame = nullptr;
+}
+
+void preprocess_func(DetectorEnvironment* env, camera_settings* set, FrameContext* ctx)
+{
+	env->original_size = ctx->frame.size();
+	cpu_preprocessing(ctx->frame, env->frame_transform, env->border_dims, &env->frame_pool);
+}
+
+void publish_func(DetectorEnvironment* env, FrameContext* ctx)
+{
 	if (env->is_sort_results) {
-		detections.sort([](DetectionItem* a, DetectionItem* b) { return a->priority < b->priority; });
+		std::stable_sort(ctx->detections.begin(), ctx->detections.end(), [](DetectionItem* a, DetectionItem* b) { return a->priority < b->priority; });
+	}
+
+	if (ctx->detections.size() > 0 || env->mqtt_is_send_empty) {
+		send_results_thread(env, ctx->detections);
 	}
 
-	if (detections.size() > 0 || env->mqtt_is_send_empty) {
-		send_results_thread(env, detections);
+#ifdef _DEBUG_
+	env->fps.tick("##########Output FPS: ", env->camera_id.c_str(), env->http_server_queue);
+
+	if (ctx->sequence % 300 == 0) {
+		cout << "[FramePool] Camera: " << env->camera_id << " used: " << env->frame_pool.get_used_buffers() << " free: " << env->frame_pool.get_free_buffers()
+			<< " occupancy: " << env->frame_pool.get_occupancy() << " peak MB: " << env->frame_pool.get_peak_used_bytes() / (1024 * 1024)
+			<< " rejected: " << env->frame_pool.get_rejected() << endl;
+
+		if (env->capture != nullptr)
+			cout << "[Capture] Camera: " << env->camera_id << " skipped frames: " << env->capture->get_skipped_frames() << endl;
+
+		if (env->motion_gate.get_is_enabled()) {
+			cout << "[MotionGate] Camera: " << env->camera_id << " passed: " << env->motion_gate.get_passed() << " forced: " << env->motion_gate.get_forced()
+				<< " skipped: " << env->motion_gate.get_skipped() << endl;
+		}
+
+		std::vector<std::pair<std::string, double>> stage_durations;
+		for (auto& detector : env->detectors) {
+			detector->get_stage_durations(stage_durations);
+			if (!stage_durations.empty()) {
+				cout << "[Stages] Camera: " << env->camera_id << " detector: " << detector->id << " ms:";
+				for (auto& stage : stage_durations) {
+					cout << " " << stage.first << " " << stage.second;
+				}
+				cout << endl;
+				stage_durations.clear();
+			}
+
+			CascadeObjectDetector* cascade = dynamic_cast<CascadeObjectDetector*>(detector);
+			if (cascade != nullptr) {
+				cout << "[Cascade] Camera: " << env->camera_id << " detector: " << detector->id << " frames: " << cascade->get_frames()
+					<< " escalated: " << cascade->get_escalated() << " fraction: " << cascade->get_escalation_fraction() << " regions: " << cascade->get_regions() << endl;
+			}
+
+			if (detector->detect_timeout_ms > 0) {
+				cout << "[Deadline] Camera: " << env->camera_id << " detector: " << detector->id << " timeout ms: " << detector->detect_timeout_ms
+					<< " calls: " << detector->get_async_calls() << " timeouts: " << detector->get_timeouts() << " busy skips: " << detector->get_busy_skips() << endl;
+			}
+
+			if (!detector->tiles.get_is_enabled())
+				continue;
+
+			cout << "[Tiles] Camera: " << env->camera_id << " detector: " << detector->id << " ms per tile:";
+			for (auto& duration : detector->tiles.get_mean_durations()) {
+				cout << " " << duration;
+			}
+			cout << endl;
+		}
 	}
+#endif
+}
 
+void render_func(DetectorEnvironment* env, FrameContext* ctx)
+{
 #ifdef __WITH_VIDEO_STREAMER__
-	if (env->video_stream_mode == VIDEO_STREAM_MODE::VIDEO_STREAM_MODE_DETECTOR && env->video_streamer != nullptr) {
-		draw_detections(env, env->detect_frame, detections);
-		stream_frame(env->detect_frame, env);
+	if (env->stream_channel.is_pending()) {
+		env->stream_channel.skip();
+		return;
 	}
+
+	// the frame is not used after this stage, so it is drawn on and handed to the streamer without a copy
+	draw_detections(env, &ctx->frame, ctx->detections);
+	std::string title = env->get_frame_title();
+	if (!title.empty() || env->draw_fps)
+		draw_frame_title(&ctx->frame, title);
+
+	env->stream_channel.put(ctx->frame);
 #endif
+}
 
-	clear<DetectionItem, std::list>(detections);
+/*
+* Inference of all cameras shares one work-stealing pool, so the total number of running
+* inference threads is bounded by device settings "inference_threads" instead of the camera count.
+* The stage thread only waits for the job, an idle worker picks it up or steals it.
+* Frames rejected by the motion gate (camera additional settings motion_gate, motion_gate_width,
+* motion_gate_threshold, motion_gate_min_area_permille, motion_gate_idle_interval_ms,
+* motion_gate_learning_percent) don`t reach the pool. With motion_gate_crop root detectors get only the changed
+* areas (motion_gate_crop_padding_percent, motion_gate_crop_max_percent), objects outside of them are reported
+* on the frames inferred whole.
+*/
+void inference_func(DetectorEnvironment* env, FrameContext* ctx)
+{
+	if (!env->motion_gate.check(ctx->frame, ctx->motion_regions)) {
+		// nothing has changed, the results of the last inferred frame still hold
+		for (auto& d : env->gated_detections)
+			ctx->detections.push_back(ctx->arena.create(d));
+		return;
+	}
+
+	WorkStealingPool* pool = WorkStealingPool::get_instance();
+
+	JobGroup group;
+	pool->submit([env, ctx]() { detect_func(env, ctx); }, &group);
+	pool->wait(group);
+
+	if (env->motion_gate.get_is_enabled()) {
+		env->gated_detections.clear();
+		env->gated_arena.reset();
+		for (auto& d : ctx->detections)
+			env->gated_detections.push_back(env->gated_arena.create(d));
+	}
 }
 
-void thread_func(DetectorEnvironment* env)
+int get_pipeline_queue_size(camera_settings* set, const char* stage, int defval)
 {
-	while (true) {
-		if (!env->detector_ready) {
-			//env->smphSignalMainToThread.acquire();
-			detect_func(env);
-#ifdef _DEBUG_
-			env->fps.tick("##########Output FPS: ", env->camera_id.c_str(), env->http_server_queue);
+	int size = set->additional.get<int>("pipeline_queue_size", defval);
+	return set->additional.get<int>(string("pipeline_") + stage + "_queue_size", size);
+}
+
+QUEUE_DROP_POLICY get_pipeline_drop_policy(camera_settings* set, const char* stage, QUEUE_DROP_POLICY defval)
+{
+	auto policy = set->additional.get<string>(string("pipeline_") + stage + "_drop_policy", "");
+	return queue_drop_policy_from_string(policy, defval);
+}
+
+/*
+* capture -> preprocess -> inference -> publish -> render
+* Capture runs on the camera loop thread and pushes into the preprocess queue. Every other stage
+* has its own thread and an input queue whose size and drop policy come from the camera`s
+* additional settings: pipeline_<stage>_queue_size, pipeline_<stage>_drop_policy ("newest" or "block").
+*/
+bool create_pipeline(DetectorEnvironment* env, camera_settings* set)
+{
+	env->pipeline = new Pipeline<FrameContext>();
+	if (env->pipeline == nullptr)
+		return false;
+
+	// contexts leaving the pipeline are recycled with their detection arenas instead of being deleted
+	env->pipeline->set_deleter([env](FrameContext* ctx) { env->context_pool.put(ctx); });
+
+	env->pipeline->add_stage("preprocess", [env, set](FrameContext* ctx) { preprocess_func(env, set, ctx); return true; },
+		get_pipeline_queue_size(set, "preprocess", 1), get_pipeline_drop_policy(set, "preprocess", QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_NEWEST_WINS));
+	env->pipeline->add_stage("inference", [env](FrameContext* ctx) { inference_func(env, ctx); return true; },
+		get_pipeline_queue_size(set, "inference", 1), get_pipeline_drop_policy(set, "inference", QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_BLOCK));
+
+	bool is_render = false;
+#ifdef __WITH_VIDEO_STREAMER__
+	is_render = env->video_stream_mode == VIDEO_STREAM_MODE::VIDEO_STREAM_MODE_DETECTOR && env->video_streamer != nullptr;
 #endif
-			env->detector_ready = true;
-		}
+	env->pipeline->add_stage("publish", [env, is_render](FrameContext* ctx) { publish_func(env, ctx); return is_render; },
+		get_pipeline_queue_size(set, "publish", 4), get_pipeline_drop_policy(set, "publish", QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_BLOCK));
+	if (is_render) {
+		env->pipeline->add_stage("render", [env](FrameContext* ctx) { render_func(env, ctx); return true; },
+			get_pipeline_queue_size(set, "render", 1), get_pipeline_drop_policy(set, "render", QUEUE_DROP_POLICY::QUEUE_DROP_POLICY_NEWEST_WINS));
 	}
+
+	return env->pipeline->start();
 }
 
 void process_frame(ICamera* capture, cs::camera_settings* set, DetectorEnvironment* environment, Mat* frame)
@@ -617,22 +1078,17 @@ void process_frame(ICamera* capture, cs::camera_settings* set, DetectorEnvironme
 	if (frame->empty())
 		return;
 
-	if (environment->is_undistort) {
-		if (!environment->map1.empty() && !environment->map2.empty()) {
-			cv::remap(*frame, *frame, environment->map1, environment->map2, cv::INTER_LINEAR);
-		}
-	}
+	capture->set_ready(false);
 
-	if (environment->detector_ready) {
-		environment->original_size = frame->size();
+	FrameContext* ctx = environment->context_pool.get();
+	if (ctx == nullptr)
+		return;
 
-		cpu_preprocessing(*frame, set, environment->border_dims);
-		environment->detect_frame = frame;
+	ctx->frame = *frame;
+	ctx->sequence = environment->frame_sequence++;
+	ctx->capture_time = std::chrono::steady_clock::now();
 
-		capture->set_ready(false);
-		//environment->smphSignalMainToThread.release(); // signal to start detection
-		environment->detector_ready = false;
-	}
+	environment->pipeline->push(ctx);
 }
 
 ICamera* create_input_device(cs::camera_settings* set)
@@ -688,13 +1144,19 @@ void* camera_loop(void* arg)
 	}
 	capture->prepare();
 
+	// frames are captured into the camera`s pool, so the environment has to outlive the capture
+	DetectorEnvironment environment;
+	environment.frame_pool.set_memory_limit(static_cast<size_t>(set->additional.get<int>("frame_pool_memory_limit_mb", 0)) * 1024 * 1024);
+	capture->set_frame_pool(&environment.frame_pool);
+
 	if (!capture->open(set, params->mqtt_client) || capture->get_height() <= 0 || capture->get_width() <= 0) {
 		cout << "Can not open capture: " << get<string>(set->device).c_str() << endl;
 		delete capture;
 		return nullptr;
 	}
 
-	DetectorEnvironment environment;
+	environment.capture = capture;
+
 	if (!init_detectors_environment(&environment, set, capture, params->mqtt_client)) {
 		delete capture;
 		return nullptr;
@@ -715,46 +1177,38 @@ void* camera_loop(void* arg)
 		fps.init();
 	}
 #endif
-	environment.detector_ready = true;
-
-	thread detect_tread(thread_func, &environment);
-	detect_tread.detach();
+	if (!create_pipeline(&environment, set)) {
+		cout << "Can not start processing pipeline for camera: " << set->id << endl;
+		delete capture;
+		return nullptr;
+	}
 
 	if (set->video_stream_mode != VIDEO_STREAM_MODE::VIDEO_STREAM_MODE_NONE && environment.video_streamer != nullptr) {
 		thread stream_tread(stream_thread_func, &environment);
 		stream_tread.detach();
 	}
 
-	cv::Mat buffers[2]{cv::Mat(capture->get_height(), capture->get_width(), CV_8UC3), cv::Mat(capture->get_height(), capture->get_width(), CV_8UC3)};
-	buffers[0].release();
-	buffers[1].release();
-	int ind = 0;
-	cv::Mat* frame = &buffers[ind];
+	cv::Mat frame;
 
 	for (;;) {
-		if (!capture->is_ready()) {
-			cout << "Capture is not ready" << endl;
+		// the loop sleeps until the source has a frame, its buffer is filled in the background
+		if (!capture->wait_ready(std::chrono::milliseconds(1000)))
 			continue;
-		}
-
-		//environment.smphSignalMainToThread.acquire(); // wait for signal to start detection
-		if (frame != nullptr && environment.detector_ready) {
-			if (!frame->empty()) {
-				process_frame(capture, set, &environment, frame);
-				ind = 1 - ind;
-				frame = &buffers[ind];
-			}
-		}
 
-		int ret = capture->get_frame(*frame, set->get_is_convert_to_gray());
+		int ret = capture->get_frame(frame, set->get_is_convert_to_gray());
 
 #ifdef __WITH_VIDEO_STREAMER__
-		if (set->video_stream_mode == VIDEO_STREAM_MODE::VIDEO_STREAM_MODE_SOURCE && environment.video_streamer != nullptr) {
-			environment.is_can_show = true;
-			stream_frame(frame, &environment);
+		if (set->video_stream_mode == VIDEO_STREAM_MODE::VIDEO_STREAM_MODE_SOURCE && environment.video_streamer != nullptr && !frame.empty()) {
+			stream_frame(&frame, &environment);
 		}
 #endif
 
+		if (!frame.empty()) {
+			process_frame(capture, set, &environment, &frame);
+			// the pipeline owns the handed off buffer now, next capture gets a fresh one
+			frame.release();
+		}
+
 #ifdef _DEBUG_
 		if (set->input_kind == INPUT_OUTPUT_DEVICE_KIND::INPUT_OUTPUT_DEVICE_KIND_CAMERA) {
 			fps.tick("!!!!!!!!!Input FPS: ", "", nullptr);
@@ -773,25 +1227,26 @@ void* camera_loop(void* arg)
 		}
 	}
 	
-	delete capture;
+	// the stages read the capture`s statistics, they are stopped first
 	cleanup_detectors_environment(&environment);
+	environment.capture = nullptr;
+	delete capture;
 
 	return NULL;
 }
 
-void cpu_preprocessing(Mat& frame, camera_settings* set, Size& border_dims)
+void cpu_preprocessing(Mat& frame, FrameTransform& transform, Size& border_dims, FramePool* pool)
 {
 	border_dims.width = 0;
 	border_dims.height = 0;
 
-	if (set->is_flip) {
-		cv::flip(frame, frame, 1);
-	}
+	if (transform.get_is_identity())
+		return;
 
-	if (set->get_rotate_angle() != 0) {
-		Mat rotate;
-		cpu_rotate(frame, rotate, set->get_rotate_angle());
-		rotate.copyTo(frame);
-	}
+	Mat dst;
+	if (pool != nullptr)
+		pool->acquire(dst, frame.size(), frame.type());
+	if (transform.apply(frame, dst))
+		frame = dst;
 }
 
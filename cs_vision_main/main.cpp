@@ -37,6 +37,8 @@
 #include "MQTTClient.h"
 #include "device_manager.h";
 #include "std_utils.h"
+#include "WorkStealingPool.h"
+#include "ThreadBudget.h"
 #ifdef __WITH_SCRIPT_LANG__
 #include "CSScript.h"
 #endif
@@ -144,6 +146,18 @@ int main(int argc, char* argv[])
             cout << "Cannot allocate memory for command`s topic MQTT client. Broker IP: " << settings->mqtt_broker_ip.c_str() << " port: " << settings->mqtt_broker_port << endl;
     }
 
+    WorkStealingPool::get_instance()->init(settings->inference_threads);
+
+    // backends split the cores between the detectors which the pool can run at once
+    int detectors_count = 0;
+    for (auto& camera : settings->cameras) {
+        if (camera->is_enabled)
+            detectors_count += static_cast<int>(camera->detectors.size());
+    }
+    ThreadBudget::get_instance()->init(settings->thread_budget_cores, WorkStealingPool::get_instance()->get_workers_count(), detectors_count);
+    // OpenCV calls come from the pool workers already, its own pool only adds runnable threads
+    cv::setNumThreads(ThreadBudget::get_instance()->assign_per_worker("global", "opencv"));
+
     list<camera_thread_description*> camera_threads;
     for (auto& camera : settings->cameras) {
         if (camera->is_enabled) {
@@ -200,6 +214,7 @@ int main(int argc, char* argv[])
     }
 
     clear<camera_thread_description, std::list>(camera_threads);
+    WorkStealingPool::get_instance()->shutdown();
     delete settings;
     if (mqtt != nullptr)
         delete mqtt;
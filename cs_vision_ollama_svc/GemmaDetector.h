@@ -11,14 +11,14 @@ namespace cs
 		{
 			if (response.find("Yes") != std::string::npos)
 			{
-				DetectionItem* item = new DetectionItem();
+				DetectionItem* item = create_detection();
 				item->id = current_id;
 				current_id++;
 
 				item->kind = ObjectDetectorKind::OBJECT_DETECTOR_SVC_GEMMA3;
 				item->detector_id = id;
 
-				item->label = "Weapon!!!";
+				item->set_label("Weapon!!!");
 				item->neural_network_id = neural_network_id;
 
 				last_detections.push_back(item);
@@ -30,7 +30,7 @@ namespace cs
 			if (detect_frame == nullptr || detection == nullptr)
 				return;
 
-			cv::putText(*detect_frame, detection->label, cv::Point(10, 10), cv::FONT_HERSHEY_SIMPLEX, 0.5, detection->color, 2);
+			cv::putText(*detect_frame, detection->get_label(), cv::Point(10, 10), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(detection->color), 2);
 		}
 	};
 }
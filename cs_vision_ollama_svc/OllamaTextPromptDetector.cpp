@@ -14,7 +14,7 @@ void OllamaTextPromptDetector::clear()
 
 }
 
-int OllamaTextPromptDetector::detect(cv::Mat* input, int& current_id, bool is_draw, std::list<DetectionItem*>* detections)
+int OllamaTextPromptDetector::detect(cv::Mat* input, int& current_id, bool is_draw, DetectionSpan detections)
 {
 	const char* prompt = (const char*)input->data;
 	if (prompt == nullptr || strlen(prompt) == 0) {
@@ -31,10 +31,10 @@ void OllamaTextPromptDetector::parse(const std::string& response, int& current_i
 {
 	std::cout << "\a";
 
-	DetectionItem* item = new DetectionItem();
+	DetectionItem* item = create_detection();
 	item->id = current_id;
 	current_id++;
-	item->label = response;
+	item->set_label(response);
 	item->score = 1.0f;
 
 	last_detections.push_back(item);
@@ -90,14 +90,14 @@ void QwenDetector::parse(const std::string& response, int& current_id)
 						auto box = item["bbox_2d"].GetArray();
 						auto label = item["label"].GetString();
 
-						DetectionItem* item = new DetectionItem();
+						DetectionItem* item = create_detection();
 						item->id = current_id;
 						current_id++;
 
 						item->kind = ObjectDetectorKind::OBJECT_DETECTOR_QWEN;
 						item->detector_id = id;
 
-						item->label = trim(label);
+						item->set_label(trim(label));
 						item->neural_network_id = neural_network_id;
 
 						double k = 0.50;
@@ -113,14 +113,14 @@ void QwenDetector::parse(const std::string& response, int& current_id)
 			}
 		}
 		else {
-			DetectionItem* item = new DetectionItem();
+			DetectionItem* item = create_detection();
 			item->id = current_id;
 			current_id++;
 
 			item->kind = ObjectDetectorKind::OBJECT_DETECTOR_QWEN;
 			item->detector_id = id;
 
-			item->label = resp;
+			item->set_label(resp);
 			item->neural_network_id = neural_network_id;
 
 			item->box.width = -1;
@@ -23,6 +23,7 @@
 
 #include "camera_loop_utils.h"
 #include "NullObjectDetector.h"
+#include "CascadeObjectDetector.h"
 //#include "OCVYOLOv8ObjectDetector.h"
 #include "TFYOLOv5ObjectDetector.h"
 //#include "TFAudioSampleRecognizer.h"
@@ -55,6 +56,7 @@ IObjectDetector* create_detector(int kind)
 	case ObjectDetectorKind::OBJECT_DETECTOR_TENSORRT_YOLO: return new TRTYoloObjectDetector();
 	case ObjectDetectorKind::OBJECT_DETECTOR_SVC_GEMMA3: return new GemmaDetector();
 	case ObjectDetectorKind::OBJECT_DETECTOR_SVC_QWEN: return new QwenDetector();
+	case ObjectDetectorKind::OBJECT_DETECTOR_CASCADE: return new CascadeObjectDetector();
 	}
 
 	return nullptr;
@@ -223,7 +223,7 @@ void PortAudioMicrophone::set_buffer(char* data, uint length)
         memcpy(p, data, free_count);
         detector_cur_position += free_count;
 
-        ready_flag = true;
+        set_ready(true);
     }
     else {
         memcpy(p, data, length);
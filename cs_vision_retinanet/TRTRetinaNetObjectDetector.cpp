@@ -34,7 +34,7 @@ void TRTRetinaNetObjectDetector::clear()
 	// Implement any necessary cleanup logic here
 }
 
-int TRTRetinaNetObjectDetector::detect(cv::Mat* input, int& current_id, bool is_draw, std::list<DetectionItem*>* detections)
+int TRTRetinaNetObjectDetector::detect(cv::Mat* input, int& current_id, bool is_draw, DetectionSpan detections)
 {
 	if (input == nullptr)
 		return 0;
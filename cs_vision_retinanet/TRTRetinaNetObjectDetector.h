@@ -15,7 +15,7 @@ namespace cs
 
 		virtual void clear();
 
-		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, std::list<DetectionItem*>* detections = nullptr) override;
+		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, DetectionSpan detections = {}) override;
 		virtual int detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw = false) override;
 		virtual int detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw = false) override;
 		virtual void parse(const std::string& payload, int& current_id);
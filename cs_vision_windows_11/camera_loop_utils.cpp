@@ -22,11 +22,13 @@
  */
 
 #include "camera_loop_utils.h"
-//#include "OCVYOLOv8ObjectDetector.h"
+#include "OCVYOLOv8ObjectDetector.h"
 #include "NullObjectDetector.h"
+#include "CascadeObjectDetector.h"
 #include "TFYOLOv5ObjectDetector.h"
 #include "TRTYOLOObjectDetector.h"
 #include "TRTRetinaNetObjectDetector.h"
+#include "ORTYoloObjectDetector.h"
 #include "GemmaDetector.h"
 #include "QwenDetector.h"
 #include "OllamaTextPromptDetector.h"
@@ -51,12 +53,15 @@ IObjectDetector* create_detector(int kind)
 	case ObjectDetectorKind::OBJECT_DETECTOR_NONE: return new NullObjectDetector();
 	case ObjectDetectorKind::OBJECT_DETECTOR_TENSORFLOW_YOLOv5: return new TFYOLOv5ObjectDetector();
 	case ObjectDetectorKind::OBJECT_DETECTOR_TENSORRT_YOLO: return new TRTYoloObjectDetector();
+	case ObjectDetectorKind::OBJECT_DETECTOR_OPENCV_YOLOv8: return new OCVYOLOv8ObjectDetector();
 	case ObjectDetectorKind::OBJECT_DETECTOR_SVC_GEMMA3: return new GemmaDetector();
 	case ObjectDetectorKind::OBJECT_DETECTOR_SVC_QWEN: return new QwenDetector();
 	case ObjectDetectorKind::OBJECT_DETECTOR_MOT_BYTETRACK: return new TrackerByteTrack();
 	case ObjectDetectorKind::OBJECT_DETECTOR_MOT_DEEPSORT: return new TrackerDeepSORT();
 	case ObjectDetectorKind::OBJECT_DETECTOR_OLLAMA_PROMPT: return new OllamaTextPromptDetector();
 	case ObjectDetectorKind::OBJECT_DETECTOR_RETINANET: return new TRTRetinaNetObjectDetector();
+	case ObjectDetectorKind::OBJECT_DETECTOR_ONNXRUNTIME_YOLO: return new ORTYoloObjectDetector();
+	case ObjectDetectorKind::OBJECT_DETECTOR_CASCADE: return new CascadeObjectDetector();
 	}
 
 	return nullptr;
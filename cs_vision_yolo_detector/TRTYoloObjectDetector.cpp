@@ -49,7 +49,14 @@ int TRTYoloObjectDetector::init(object_detector_environment& env)
 	load_rules(env.rules_path.c_str());
 	load_labels(env.label_path.c_str());
 
-	detector = make_unique<TRTYolo>(env.model_path, trt_yolo_logger);
+	try {
+		detector = make_unique<TRTYolo>(env.model_path, trt_yolo_logger);
+	}
+	catch (const std::exception& e) {
+		cout << "[TRTYolo] " << env.model_path << " isn`t loaded: " << e.what() << endl;
+		detector = nullptr;
+		return 0;
+	}
 
 	return 1;
 }
@@ -59,7 +66,7 @@ void TRTYoloObjectDetector::clear()
 
 }
 
-void TRTYoloObjectDetector::postprocess(std::vector<Detection>* detections, int& current_id, bool is_draw, int model_h, int model_w, cv::Mat* image)
+void TRTYoloObjectDetector::postprocess(std::vector<Detection>* detections, int& current_id, bool is_draw, int model_h, int model_w, cv::Mat* image, int batch_index)
 {
 	if (detections == nullptr)
 		return;
@@ -70,10 +77,11 @@ void TRTYoloObjectDetector::postprocess(std::vector<Detection>* detections, int&
 	const float ratio_h = model_h / (float)image->rows;
 	const float ratio_w = model_w / (float)image->cols;
 
-	for (auto detection : *detections) {
-		DetectionItem* item = new DetectionItem();
-		item->color = color;
-		if (check_rule(detection.class_id, detection.conf, item->color)) {
+	for (const auto& detection : *detections) {
+		cv::Scalar item_color = color;
+		if (check_rule(detection.class_id, detection.conf, item_color)) {
+			DetectionItem* item = create_detection();
+			item->color = item_color;
 			item->id = current_id;
 			current_id++;
 
@@ -81,10 +89,8 @@ void TRTYoloObjectDetector::postprocess(std::vector<Detection>* detections, int&
 			item->class_id = detection.class_id;
 			item->detector_id = id;
 
-			std::string label;
-			get_rule_label(detection.class_id, label);
 			item->priority = get_rule_priority(detection.class_id);
-			item->label = trim(label);
+			item->set_label(get_label(detection.class_id));
 			item->score = detection.conf;
 			item->box = detection.bbox;
 
@@ -104,17 +110,16 @@ void TRTYoloObjectDetector::postprocess(std::vector<Detection>* detections, int&
 			}
 
 			item->neural_network_id = neural_network_id;
+			item->batch_index = static_cast<int16_t>(batch_index);
 
 			last_detections.push_back(item);
 		}
-		else
-			delete item;
 	}
 }
 
-int TRTYoloObjectDetector::detect(cv::Mat* input, int& current_id, bool is_draw, std::list<DetectionItem*>* detections)
+int TRTYoloObjectDetector::detect(cv::Mat* input, int& current_id, bool is_draw, DetectionSpan detections)
 {
-	if (input == nullptr)
+	if (input == nullptr || detector == nullptr)
 		return 0;
 
 	clear_last_detections();
@@ -142,6 +147,32 @@ int TRTYoloObjectDetector::detect(cv::cuda::GpuMat* input, int& current_id, bool
 
 int TRTYoloObjectDetector::detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw)
 {
-	return 0;
+	clear_last_detections();
+
+	if (detector == nullptr || input.empty() || static_cast<int>(input.size()) > detector->get_max_batch_size())
+		return 0;
+
+	for (auto& image : input) {
+		if (image == nullptr || image->empty())
+			return 0;
+	}
+
+	if (!detector->set_batch_size(static_cast<int>(input.size())))
+		return 0;
+
+	for (int i = 0; i < static_cast<int>(input.size()); i++) {
+		detector->preprocess(*input[i], i);
+	}
+
+	detector->infer();
+
+	for (int i = 0; i < static_cast<int>(input.size()); i++) {
+		vector<Detection> objects;
+		detector->postprocess(objects, i);
+
+		postprocess(&objects, current_id, is_draw, detector->get_model_height(), detector->get_model_width(), input[i], i);
+	}
+
+	return 1;
 }
 
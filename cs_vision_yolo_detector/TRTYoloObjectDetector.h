@@ -15,16 +15,17 @@ namespace cs
 		virtual int init(object_detector_environment& env) override;
 
 		virtual void clear();
-		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, std::list<DetectionItem*>* detections = nullptr) override;
+		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, DetectionSpan detections = {}) override;
 		virtual int detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw = false) override;
 		virtual int detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw = false) override;
+		virtual int get_model_batch_size() override { return detector != nullptr ? detector->get_max_batch_size() : 1; };
 	private:
 		const char* default_input_tensor_name = "";
 		const char* default_output_tensor_name = "";
 
 		std::unique_ptr<TRTYolo> detector = nullptr;
 
-		void postprocess(std::vector<Detection>* detections, int& current_id, bool is_draw, int model_h, int model_w, cv::Mat* image);
+		void postprocess(std::vector<Detection>* detections, int& current_id, bool is_draw, int model_h, int model_w, cv::Mat* image, int batch_index = -1);
 	};
 }
 
@@ -0,0 +1,166 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "ORTYoloObjectDetector.h"
+#include <iostream>
+
+using namespace cs;
+using namespace cv;
+using namespace std;
+
+int ORTYoloObjectDetector::init(object_detector_environment& env)
+{
+	load_rules(env.rules_path.c_str());
+	load_labels(env.label_path.c_str());
+
+	ort_yolo_params params;
+	if (env.additional != nullptr) {
+		params.intra_op_threads = env.additional->get<int>("ort_intra_op_threads", 0);
+		params.inter_op_threads = env.additional->get<int>("ort_inter_op_threads", params.inter_op_threads);
+		params.is_cache_optimized_model = env.additional->get<bool>("ort_cache_optimized_model", params.is_cache_optimized_model);
+		params.max_batch_size = env.additional->get<int>("ort_max_batch_size", params.max_batch_size);
+		params.input_width = env.additional->get<int>("ort_input_width", params.input_width);
+		params.input_height = env.additional->get<int>("ort_input_height", params.input_height);
+		params.layout = static_cast<ORT_YOLO_LAYOUT>(env.additional->get<int>("yolo_version", static_cast<int>(params.layout)));
+		params.conf_threshold = env.additional->get<int>("conf_threshold_percent", 30) / 100.0f;
+		params.nms.iou_threshold = env.additional->get<int>("nms_threshold_percent", 40) / 100.0f;
+		params.nms.method = static_cast<NMS_METHOD>(env.additional->get<int>("nms_method", static_cast<int>(params.nms.method)));
+		params.nms.is_class_aware = env.additional->get<bool>("nms_class_aware", params.nms.is_class_aware);
+		params.nms.pre_top_k = env.additional->get<int>("nms_pre_top_k", params.nms.pre_top_k);
+		params.nms.max_detections = env.additional->get<int>("nms_max_detections", params.nms.max_detections);
+		params.nms.soft_sigma = env.additional->get<int>("nms_soft_sigma_percent", 50) / 100.0f;
+	}
+	// threads not set by the settings are taken from the process wide budget
+	budget_owner = env.model_path;
+	params.intra_op_threads = ThreadBudget::get_instance()->assign(budget_owner, "ort", params.intra_op_threads);
+
+	// YOLO11 has the output of YOLOv8
+	if (static_cast<int>(params.layout) == 11)
+		params.layout = ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_V8;
+
+	try {
+		detector = make_unique<ORTYolo>(env.model_path, params);
+	}
+	catch (const std::exception& e) {
+		cout << "[ORTYolo] " << env.model_path << " isn`t loaded: " << e.what() << endl;
+		detector = nullptr;
+		return 0;
+	}
+
+	return 1;
+}
+
+void ORTYoloObjectDetector::clear()
+{
+	if (!budget_owner.empty()) {
+		ThreadBudget::get_instance()->release(budget_owner, "ort");
+		budget_owner.clear();
+	}
+}
+
+void ORTYoloObjectDetector::postprocess(int& current_id, int batch_index)
+{
+	for (const auto& detection : objects) {
+		cv::Scalar item_color = color;
+		if (check_rule(detection.class_id, detection.conf, item_color)) {
+			DetectionItem* item = create_detection();
+			item->color = item_color;
+			item->id = current_id;
+			current_id++;
+
+			item->kind = ObjectDetectorKind::OBJECT_DETECTOR_ONNXRUNTIME_YOLO;
+			item->class_id = detection.class_id;
+			item->detector_id = id;
+
+			item->priority = get_rule_priority(detection.class_id);
+			item->set_label(get_label(detection.class_id));
+			item->score = detection.conf;
+			item->box = detection.bbox;
+
+			item->neural_network_id = neural_network_id;
+			item->batch_index = static_cast<int16_t>(batch_index);
+
+			last_detections.push_back(item);
+		}
+	}
+}
+
+int ORTYoloObjectDetector::detect(cv::Mat* input, int& current_id, bool is_draw, DetectionSpan detections)
+{
+	if (input == nullptr || input->empty() || detector == nullptr)
+		return 0;
+
+	clear_last_detections();
+
+	if (!detector->set_batch_size(1))
+		return 0;
+
+	detector->preprocess(*input);
+	detector->infer();
+	detector->postprocess(objects);
+
+	postprocess(current_id);
+
+	return objects.size() > 0;
+}
+
+int ORTYoloObjectDetector::detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw)
+{
+	if (input == nullptr)
+		return 0;
+
+	cv::Mat img;
+	input->download(img);
+
+	return detect(&img, current_id, is_draw);
+}
+
+int ORTYoloObjectDetector::detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw)
+{
+	clear_last_detections();
+
+	if (detector == nullptr || input.empty() || static_cast<int>(input.size()) > detector->get_max_batch_size())
+		return 0;
+
+	for (auto& image : input) {
+		if (image == nullptr || image->empty())
+			return 0;
+	}
+
+	if (!detector->set_batch_size(static_cast<int>(input.size())))
+		return 0;
+
+	for (int i = 0; i < static_cast<int>(input.size()); i++) {
+		detector->preprocess(*input[i], i);
+	}
+
+	detector->infer();
+
+	for (int i = 0; i < static_cast<int>(input.size()); i++) {
+		detector->postprocess(objects, i);
+		postprocess(current_id, i);
+	}
+
+	return 1;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include "JsonWrapper.h"
+#include "IObjectDetector.h"
+#include "ort_yolo.h"
+#include "ThreadBudget.h"
+
+namespace cs
+{
+	class ORTYoloObjectDetector : public IObjectDetector
+	{
+	public:
+		ORTYoloObjectDetector() {};
+		virtual ~ORTYoloObjectDetector() { clear(); };
+
+		virtual int init(object_detector_environment& env) override;
+
+		virtual void clear();
+		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, DetectionSpan detections = {}) override;
+		virtual int detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw = false) override;
+		virtual int detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw = false) override;
+		virtual int get_model_batch_size() override { return detector != nullptr ? detector->get_max_batch_size() : 1; };
+	private:
+		std::unique_ptr<ORTYolo> detector = nullptr;
+		std::vector<ort_detection> objects;
+		std::string budget_owner = ""; // model path the threads are assigned to
+
+		void postprocess(int& current_id, int batch_index = -1);
+	};
+}
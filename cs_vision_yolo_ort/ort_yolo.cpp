@@ -0,0 +1,245 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "ort_yolo.h"
+#include <iostream>
+#include <array>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <opencv2/imgproc.hpp>
+
+using namespace cs;
+using namespace cv;
+using namespace std;
+
+Ort::Env& ORTYolo::get_env()
+{
+	static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "cs_vision");
+	return env;
+}
+
+ORTYolo::ORTYolo(const std::string& model_path, const ort_yolo_params& params) : params(params)
+{
+	this->params.nms.score_threshold = params.conf_threshold;
+	nms.set_params(this->params.nms);
+
+	// sessions are shared by the detectors with the same model and threading, Run is thread safe and
+	// every detector binds its own buffers
+	std::string key = "ort:" + model_path + ":" + std::to_string(params.intra_op_threads) + ":" + std::to_string(params.inter_op_threads)
+		+ (params.is_cache_optimized_model ? ":cached" : "");
+	session = ModelRegistry::get_instance()->acquire<Ort::Session>(key, [this, &model_path](size_t& bytes) {
+		std::error_code ec;
+		auto size = std::filesystem::file_size(model_path, ec);
+		bytes = ec ? 0 : static_cast<size_t>(size);
+		return create_session(model_path);
+	});
+
+	Ort::AllocatorWithDefaultOptions allocator;
+	input_name = session->GetInputNameAllocated(0, allocator).get();
+	output_name = session->GetOutputNameAllocated(0, allocator).get();
+
+	auto input_info = session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo();
+	if (input_info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT)
+		throw std::runtime_error("ORTYolo: only float32 inputs are supported");
+
+	auto input_shape = input_info.GetShape();
+	if (input_shape.size() != 4)
+		throw std::runtime_error("ORTYolo: input has to be NCHW");
+
+	is_dynamic_batch = input_shape[0] <= 0;
+	max_batch_size = is_dynamic_batch ? std::max(params.max_batch_size, 1) : static_cast<int>(input_shape[0]);
+	input_h = input_shape[2] > 0 ? static_cast<int>(input_shape[2]) : params.input_height;
+	input_w = input_shape[3] > 0 ? static_cast<int>(input_shape[3]) : params.input_width;
+
+	auto output_shape = session->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+	if (output_shape.size() != 3 || output_shape[1] <= 0 || output_shape[2] <= 0)
+		throw std::runtime_error("ORTYolo: output has to be [batch, attributes, anchors] or [batch, anchors, attributes]");
+
+	layout = params.layout;
+	if (layout == ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_AUTO)
+		layout = output_shape[1] < output_shape[2] ? ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_V8 : ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_V5;
+
+	if (layout == ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_V8) {
+		num_attributes = static_cast<int>(output_shape[1]);
+		num_anchors = static_cast<int>(output_shape[2]);
+		num_classes = num_attributes - 4;
+	}
+	else {
+		num_anchors = static_cast<int>(output_shape[1]);
+		num_attributes = static_cast<int>(output_shape[2]);
+		num_classes = num_attributes - 5;
+	}
+
+	if (num_classes <= 0)
+		throw std::runtime_error("ORTYolo: unexpected output shape");
+
+	tensor_pack_params pack;
+	pack.width = input_w;
+	pack.height = input_h;
+	pack.layout = TENSOR_LAYOUT::TENSOR_LAYOUT_NCHW;
+	pack.type = TENSOR_TYPE::TENSOR_TYPE_FLOAT32;
+	pack.resize = TENSOR_RESIZE::TENSOR_RESIZE_LETTERBOX_CENTER;
+	pack.is_swap_rb = true;
+	pack.pad_value = 114;
+	packer.set_params(pack);
+
+	input_buffer.resize(static_cast<size_t>(max_batch_size) * 3 * input_w * input_h, 0.0f);
+	output_buffer.resize(static_cast<size_t>(max_batch_size) * num_anchors * num_attributes, 0.0f);
+	pack_info.resize(max_batch_size);
+	decoder.set_layout(layout == ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_V8 ? YOLO_LAYOUT::YOLO_LAYOUT_V8 : YOLO_LAYOUT::YOLO_LAYOUT_V5);
+
+	binding = std::make_unique<Ort::IoBinding>(*session);
+	bind(is_dynamic_batch ? 1 : max_batch_size);
+}
+
+// graph optimizations take seconds on large models, the optimized graph is stored once and loaded as is
+std::shared_ptr<Ort::Session> ORTYolo::create_session(const std::string& model_path)
+{
+	Ort::SessionOptions options;
+	if (params.intra_op_threads > 0)
+		options.SetIntraOpNumThreads(params.intra_op_threads);
+	if (params.inter_op_threads > 0) {
+		options.SetInterOpNumThreads(params.inter_op_threads);
+		options.SetExecutionMode(params.inter_op_threads > 1 ? ExecutionMode::ORT_PARALLEL : ExecutionMode::ORT_SEQUENTIAL);
+	}
+
+	std::filesystem::path model(model_path);
+	std::filesystem::path optimized = model;
+	optimized.replace_extension(".optimized.onnx");
+
+	if (params.is_cache_optimized_model) {
+		std::error_code ec;
+		if (std::filesystem::exists(optimized, ec) && std::filesystem::last_write_time(optimized, ec) >= std::filesystem::last_write_time(model, ec)) {
+			try {
+				options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+				return std::make_shared<Ort::Session>(get_env(), optimized.c_str(), options);
+			}
+			catch (const Ort::Exception& e) {
+				std::cout << "[ORTYolo] Cached model " << optimized.string() << " isn`t loaded: " << e.what() << std::endl;
+			}
+		}
+
+		try {
+			Ort::SessionOptions cache_options = options.Clone();
+			cache_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+			cache_options.SetOptimizedModelFilePath(optimized.c_str());
+			return std::make_shared<Ort::Session>(get_env(), model.c_str(), cache_options);
+		}
+		catch (const Ort::Exception& e) {
+			std::cout << "[ORTYolo] Optimized model isn`t cached: " << e.what() << std::endl;
+		}
+	}
+
+	options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+	return std::make_shared<Ort::Session>(get_env(), model.c_str(), options);
+}
+
+// tensors are views of the preallocated buffers, rebinding doesn`t allocate
+void ORTYolo::bind(int size)
+{
+	std::array<int64_t, 4> input_shape = { size, 3, input_h, input_w };
+	std::array<int64_t, 3> output_shape = { size, 0, 0 };
+	if (layout == ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_V8) {
+		output_shape[1] = num_attributes;
+		output_shape[2] = num_anchors;
+	}
+	else {
+		output_shape[1] = num_anchors;
+		output_shape[2] = num_attributes;
+	}
+
+	Ort::Value input = Ort::Value::CreateTensor<float>(memory_info, input_buffer.data(), static_cast<size_t>(size) * 3 * input_w * input_h, input_shape.data(), input_shape.size());
+	Ort::Value output = Ort::Value::CreateTensor<float>(memory_info, output_buffer.data(), static_cast<size_t>(size) * num_anchors * num_attributes, output_shape.data(), output_shape.size());
+
+	binding->ClearBoundInputs();
+	binding->ClearBoundOutputs();
+	binding->BindInput(input_name.c_str(), input);
+	binding->BindOutput(output_name.c_str(), output);
+
+	batch_size = size;
+}
+
+// static batch models are always executed with their full batch, the tail slots are ignored
+bool ORTYolo::set_batch_size(int size)
+{
+	if (size < 1 || size > max_batch_size)
+		return false;
+
+	if (is_dynamic_batch && size != batch_size)
+		bind(size);
+
+	return true;
+}
+
+void ORTYolo::preprocess(const cv::Mat& image, int batch_index)
+{
+	if (batch_index < 0 || batch_index >= max_batch_size || image.empty())
+		return;
+
+	const Mat* src = &image;
+	if (image.channels() == 1) {
+		cvtColor(image, bgr, COLOR_GRAY2BGR);
+		src = &bgr;
+	}
+
+	float* dst = input_buffer.data() + static_cast<size_t>(batch_index) * 3 * input_w * input_h;
+	packer.pack(src->data, src->step, src->cols, src->rows, src->channels(), dst, &pack_info[batch_index]);
+}
+
+void ORTYolo::infer()
+{
+	session->Run(Ort::RunOptions{ nullptr }, *binding);
+}
+
+void ORTYolo::postprocess(std::vector<ort_detection>& output, int batch_index)
+{
+	output.clear();
+	if (batch_index < 0 || batch_index >= batch_size)
+		return;
+
+	candidates.clear();
+	const float* data = output_buffer.data() + static_cast<size_t>(batch_index) * num_anchors * num_attributes;
+	decoder.decode(data, num_anchors, num_classes, params.conf_threshold, candidates);
+
+	// image = (tensor - pad) / scale
+	const tensor_pack_info& info = pack_info[batch_index];
+	for (size_t i = 0; i < candidates.size(); i++) {
+		candidates.x[i] = (candidates.x[i] - info.pad_x) / info.scale_x;
+		candidates.y[i] = (candidates.y[i] - info.pad_y) / info.scale_y;
+		candidates.w[i] /= info.scale_x;
+		candidates.h[i] /= info.scale_y;
+	}
+
+	nms.run(candidates, nms_result);
+
+	output.reserve(nms_result.size());
+	for (int idx : nms_result) {
+		ort_detection result;
+		result.class_id = candidates.class_ids[idx];
+		result.conf = candidates.scores[idx];
+		result.bbox = cv::Rect2f(candidates.x[idx], candidates.y[idx], candidates.w[idx], candidates.h[idx]);
+		output.push_back(result);
+	}
+}
@@ -0,0 +1,121 @@
+/**
+ * @file
+ *
+ * @author      Alexander Epstine
+ * @mail        a@epstine.com
+ * @brief
+ *
+ **************************************************************************************
+ * Copyright (c) 2025, Alexander Epstine (a@epstine.com)
+ **************************************************************************************
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <opencv2/core.hpp>
+#include "onnxruntime_cxx_api.h"
+#include "TensorPacker.h"
+#include "YoloDecoder.h"
+#include "NonMaxSuppression.h"
+#include "ModelRegistry.h"
+
+namespace cs
+{
+	class ort_detection
+	{
+	public:
+		float conf = 0;
+		int class_id = -1;
+		cv::Rect2f bbox; // in the coordinates of the source image
+	};
+
+	enum class ORT_YOLO_LAYOUT
+	{
+		ORT_YOLO_LAYOUT_AUTO = 0,
+		ORT_YOLO_LAYOUT_V5 = 5,		// [batch, anchors, 5 + classes], objectness in the 5th attribute
+		ORT_YOLO_LAYOUT_V8 = 8		// [batch, 4 + classes, anchors], YOLOv8/YOLO11
+	};
+
+	class ort_yolo_params
+	{
+	public:
+		int intra_op_threads = 0;	// 0 - ONNX Runtime default (one per physical core)
+		int inter_op_threads = 0;
+		bool is_cache_optimized_model = true; // optimized graph is saved next to the model and loaded on the next start
+		int max_batch_size = 1;		// models with dynamic batch dimension
+		int input_width = 640;		// models with dynamic spatial dimensions
+		int input_height = 640;
+		ORT_YOLO_LAYOUT layout = ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_AUTO;
+		float conf_threshold = 0.3f;
+		nms_params nms;				// score_threshold is conf_threshold
+	};
+
+	/*
+	* YOLOv5/v8/v11 ONNX model executed by ONNX Runtime on CPU. Input and output tensors are allocated once
+	* and bound to the session, images are letterboxed straight into the input tensor by TensorPacker.
+	*/
+	class ORTYolo
+	{
+	public:
+		ORTYolo(const std::string& model_path, const ort_yolo_params& params);
+		virtual ~ORTYolo() {};
+
+		bool set_batch_size(int size);
+		void preprocess(const cv::Mat& image, int batch_index = 0);
+		void infer();
+		void postprocess(std::vector<ort_detection>& output, int batch_index = 0);
+
+		int get_model_width() const { return input_w; };
+		int get_model_height() const { return input_h; };
+		int get_max_batch_size() const { return max_batch_size; };
+	private:
+		static Ort::Env& get_env();
+		std::shared_ptr<Ort::Session> create_session(const std::string& model_path);
+		void bind(int size);
+
+		ort_yolo_params params;
+
+		std::shared_ptr<Ort::Session> session;	// shared through ModelRegistry
+		std::unique_ptr<Ort::IoBinding> binding;
+		Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+		std::string input_name;
+		std::string output_name;
+
+		int input_w = 0;
+		int input_h = 0;
+		int max_batch_size = 1;
+		int batch_size = 0;		// bound batch size
+		bool is_dynamic_batch = false;
+		int num_anchors = 0;
+		int num_attributes = 0;
+		int num_classes = 0;
+		ORT_YOLO_LAYOUT layout = ORT_YOLO_LAYOUT::ORT_YOLO_LAYOUT_V8;
+
+		TensorPacker packer;
+		std::vector<tensor_pack_info> pack_info;
+		std::vector<float> input_buffer;
+		std::vector<float> output_buffer;
+
+		// decoding buffers, reused
+		YoloOutputDecoder decoder;
+		yolo_candidates candidates;
+		NonMaxSuppression nms;
+		std::vector<int> nms_result;
+		cv::Mat bgr;
+	};
+}
@@ -1,10 +1,14 @@
 #include "preprocess.h"
 #include "cuda_utils.h"
 #include "device_launch_parameters.h"
+#include <mutex>
 
 #define TRT_BUILD_RTX 
 
 static uint8_t* img_buffer_device = nullptr;
+// detectors sharing an engine init and destroy the buffer each
+static int img_buffer_users = 0;
+static std::mutex img_buffer_mutex;
 
 struct AffineMatrix {
     float value[6];
@@ -133,10 +137,16 @@ void cuda_preprocess(
 }
 
 void cuda_preprocess_init(int max_image_size) {
-	printf("\nYolo TRT: 5\n");
-    CUDA_CHECK(cudaMalloc((void**)&img_buffer_device, max_image_size * 3));
+    std::lock_guard<std::mutex> lock(img_buffer_mutex);
+    if (img_buffer_users++ == 0) {
+        CUDA_CHECK(cudaMalloc((void**)&img_buffer_device, max_image_size * 3));
+    }
 }
 
 void cuda_preprocess_destroy() {
-    CUDA_CHECK(cudaFree(img_buffer_device));
+    std::lock_guard<std::mutex> lock(img_buffer_mutex);
+    if (img_buffer_users > 0 && --img_buffer_users == 0) {
+        CUDA_CHECK(cudaFree(img_buffer_device));
+        img_buffer_device = nullptr;
+    }
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <NvOnnxParser.h>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 #ifdef __WITH_FILESYSTEM_CXX__
 #include <filesystem>
 #endif
@@ -22,27 +23,50 @@ static Logger logger;
 
 TensorRT::TensorRT(std::string model_path, nvinfer1::ILogger& logger)
 {
+    // the engine is deserialized (or built) by the first detector with the model, the others share it
+    shared_engine = cs::ModelRegistry::get_instance()->acquire<TensorRTEngine>("trt:" + model_path, [this, &model_path, &logger](size_t& bytes) {
 #ifdef __WITH_FILESYSTEM_CXX__
-    if (to_lower(std::filesystem::path(model_path).extension().string()) == ".onnx") {
+        if (to_lower(std::filesystem::path(model_path).extension().string()) == ".onnx") {
 #else
-    if (model_path.find(".onnx") != std::string::npos) {
+        if (model_path.find(".onnx") != std::string::npos) {
 #endif
-        build_engine(model_path, logger);
-        save_engine(model_path);
-    }
-    else {
-        init_engine(model_path, logger);
-    }
+            build_engine(model_path, logger);
+            save_engine(model_path);
+        }
+        else {
+            init_engine(model_path, logger);
+        }
+
+        auto loaded = std::make_shared<TensorRTEngine>();
+        loaded->runtime = runtime;
+        loaded->engine = engine;
+        bytes = engine_size;
+        return engine != nullptr ? loaded : nullptr;
+    });
+
+    if (shared_engine == nullptr)
+        throw std::runtime_error("TensorRT: engine isn`t loaded: " + model_path);
+
+    runtime = shared_engine->runtime;
+    engine = shared_engine->engine;
+    context = engine->createExecutionContext();
+    cuda_preprocess_init(MAX_IMAGE_SIZE);
 
 #if NV_TENSORRT_MAJOR < 10 && TRT_BUILD_RTX != 21
     auto input_dims = engine->getBindingDimensions(0);
     input_h = input_dims.d[2];
     input_w = input_dims.d[3];
+    is_dynamic_batch = input_dims.d[0] < 0;
+    max_batch_size = is_dynamic_batch ? engine->getProfileDimensions(0, 0, OptProfileSelector::kMAX).d[0] : input_dims.d[0];
 #else
     auto input_dims = engine->getTensorShape(engine->getIOTensorName(0));
     input_h = input_dims.d[2];
     input_w = input_dims.d[3];
+    is_dynamic_batch = input_dims.d[0] < 0;
+    max_batch_size = is_dynamic_batch ? engine->getProfileShape(engine->getIOTensorName(0), 0, OptProfileSelector::kMAX).d[0] : input_dims.d[0];
 #endif
+    if (max_batch_size < 1)
+        max_batch_size = 1;
 }
 
 TensorRT::~TensorRT()
@@ -52,8 +76,6 @@ TensorRT::~TensorRT()
 
     cuda_preprocess_destroy();
     delete context;
-    delete engine;
-    delete runtime;
 }
 
 void TensorRT::preprocess(Mat& image, float* input_buffer)
@@ -80,10 +102,9 @@ bool TensorRT::init_engine(std::string engine_path, nvinfer1::ILogger& logger)
         cout << "Failed to deserialize engine" << endl;
         return false;
     }
+    engine_size = modelSize;
 
     print_engine_info(engine);
-    cuda_preprocess_init(MAX_IMAGE_SIZE);
-    context = engine->createExecutionContext();
 
     return true;
 }
@@ -104,8 +125,7 @@ void TensorRT::build_engine(std::string onnx_path, nvinfer1::ILogger& logger)
     runtime = createInferRuntime(logger);
 
     engine = runtime->deserializeCudaEngine(plan->data(), plan->size());
-
-    context = engine->createExecutionContext();
+    engine_size = plan->size();
 
     delete network;
     delete config;
@@ -173,15 +193,22 @@ void TRTYolo::init()
 #endif
 
 #ifdef TRT_BUILD_RTX == 21
-    cpu_output_buffer = new float[detection_attribute_size * num_detections];
+    cpu_output_buffer = new float[max_batch_size * detection_attribute_size * num_detections];
 
-    CUDA_CHECK(cudaMalloc(&gpu_buffers[0], 3 * input_w * input_h * sizeof(float)));
-    CUDA_CHECK(cudaMalloc(&gpu_buffers[1], detection_attribute_size * num_detections * sizeof(float)));
+    CUDA_CHECK(cudaMalloc(&gpu_buffers[0], max_batch_size * 3 * input_w * input_h * sizeof(float)));
+    CUDA_CHECK(cudaMalloc(&gpu_buffers[1], max_batch_size * detection_attribute_size * num_detections * sizeof(float)));
 #else
-    CUDA_CHECK(cudaHostAlloc(&gpu_buffers[0], 3 * input_w * input_h * sizeof(float), cudaHostAllocWriteCombined));
-    CUDA_CHECK(cudaHostAlloc(&gpu_buffers[1], detection_attribute_size * num_detections * sizeof(float), cudaHostAllocPortable));
+    CUDA_CHECK(cudaHostAlloc(&gpu_buffers[0], max_batch_size * 3 * input_w * input_h * sizeof(float), cudaHostAllocWriteCombined));
+    CUDA_CHECK(cudaHostAlloc(&gpu_buffers[1], max_batch_size * detection_attribute_size * num_detections * sizeof(float), cudaHostAllocPortable));
 #endif
 
+    set_batch_size(1);
+
+    cs::nms_params nms_settings;
+    nms_settings.score_threshold = conf_threshold;
+    nms_settings.iou_threshold = nms_threshold;
+    nms.set_params(nms_settings);
+
 #if NV_TENSORRT_MAJOR >= 10 || TRT_BUILD_RTX == 21
 	context->setTensorAddress(engine->getIOTensorName(0), gpu_buffers[0]);
 	context->setTensorAddress(engine->getIOTensorName(1), gpu_buffers[1]);
@@ -207,59 +234,85 @@ void TRTYolo::infer()
 }
 
 void TRTYolo::preprocess(cv::Mat& image) {
-    TensorRT::preprocess(image, gpu_buffers[0]);
+    set_batch_size(1);
+    preprocess(image, 0);
 }
 
 void TRTYolo::postprocess(vector<Detection>& output)
 {
-#ifdef TRT_BUILD_RTX == 21
-    CUDA_CHECK(cudaMemcpyAsync(cpu_output_buffer, gpu_buffers[1], num_detections * detection_attribute_size * sizeof(float), cudaMemcpyDeviceToHost, stream));
-    CUDA_CHECK(cudaStreamSynchronize(stream));
-#endif
+    postprocess(output, 0);
+}
 
-    boxes.clear();
-    class_ids.clear();
-    confidences.clear();
+// static engines are always executed with their full batch, the tail slots are ignored
+bool TRTYolo::set_batch_size(int size)
+{
+    if (size < 1 || size > max_batch_size)
+        return false;
 
-#ifdef TRT_BUILD_RTX == 21
-    const Mat det_output(detection_attribute_size, num_detections, CV_32F, cpu_output_buffer);
+    if (!is_dynamic_batch || size == batch_size) {
+        batch_size = size;
+        return true;
+    }
+
+#if NV_TENSORRT_MAJOR < 10 && TRT_BUILD_RTX != 21
+    if (!context->setBindingDimensions(0, Dims4{ size, 3, input_h, input_w }))
+        return false;
 #else
-    const Mat det_output(detection_attribute_size, num_detections, CV_32F, gpu_buffers[1]);
+    if (!context->setInputShape(engine->getIOTensorName(0), Dims4{ size, 3, input_h, input_w }))
+        return false;
 #endif
 
-    Point class_id_point;
-    double score;
-    Rect box;
+    batch_size = size;
+    return true;
+}
+
+void TRTYolo::preprocess(cv::Mat& image, int batch_index)
+{
+    if (batch_index < 0 || batch_index >= max_batch_size)
+        return;
+
+    // cuda_preprocess expects packed rows, predecessor`s crops are ROIs of the frame
+    if (image.isContinuous()) {
+        TensorRT::preprocess(image, gpu_buffers[0] + (size_t)batch_index * 3 * input_w * input_h);
+    }
+    else {
+        Mat packed = image.clone();
+        TensorRT::preprocess(packed, gpu_buffers[0] + (size_t)batch_index * 3 * input_w * input_h);
+        CUDA_CHECK(cudaStreamSynchronize(stream));
+    }
+}
+
+void TRTYolo::postprocess(vector<Detection>& output, int batch_index)
+{
+    if (batch_index < 0 || batch_index >= max_batch_size)
+        return;
+
+    const size_t output_offset = (size_t)batch_index * num_detections * detection_attribute_size;
 
-    for (int i = 0; i < det_output.cols; ++i) {
-        minMaxLoc(det_output.col(i).rowRange(4, 4 + num_classes), nullptr, &score, nullptr, &class_id_point);
+#ifdef TRT_BUILD_RTX == 21
+    CUDA_CHECK(cudaMemcpyAsync(cpu_output_buffer + output_offset, gpu_buffers[1] + output_offset, num_detections * detection_attribute_size * sizeof(float), cudaMemcpyDeviceToHost, stream));
+    CUDA_CHECK(cudaStreamSynchronize(stream));
+#endif
 
-        if (score > conf_threshold) {
-            const float cx = det_output.at<float>(0, i);
-            const float cy = det_output.at<float>(1, i);
-            const float ow = det_output.at<float>(2, i);
-            const float oh = det_output.at<float>(3, i);
+    candidates.clear();
 
-            box.x = static_cast<int>((cx - 0.5 * ow));
-            box.y = static_cast<int>((cy - 0.5 * oh));
-            box.width = static_cast<int>(ow);
-            box.height = static_cast<int>(oh);
+#ifdef TRT_BUILD_RTX == 21
+    const float* det_output = cpu_output_buffer + output_offset;
+#else
+    const float* det_output = gpu_buffers[1] + output_offset;
+#endif
 
-            boxes.push_back(box);
-            class_ids.push_back(class_id_point.y);
-            confidences.push_back(score);
-        }
-    }
+    // [4 + classes, anchors]
+    decoder.decode(det_output, num_detections, num_classes, conf_threshold, candidates);
 
-    nms_result.clear();
-    dnn::NMSBoxes(boxes, confidences, conf_threshold, nms_threshold, nms_result);
+    nms.run(candidates, nms_result);
 
     for (int i = 0; i < nms_result.size(); i++) {
         Detection result;
         int idx = nms_result[i];
-        result.class_id = class_ids[idx];
-        result.conf = confidences[idx];
-        result.bbox = boxes[idx];
+        result.class_id = candidates.class_ids[idx];
+        result.conf = candidates.scores[idx];
+        result.bbox = Rect(static_cast<int>(candidates.x[idx]), static_cast<int>(candidates.y[idx]), static_cast<int>(candidates.w[idx]), static_cast<int>(candidates.h[idx]));
         output.push_back(result);
     }
 }
@@ -6,6 +6,9 @@
 #endif
 #include <opencv2/opencv.hpp>
 #include <vector>
+#include "YoloDecoder.h"
+#include "NonMaxSuppression.h"
+#include "ModelRegistry.h"
 
 struct Detection
 {
@@ -14,6 +17,20 @@ struct Detection
     cv::Rect bbox;
 };
 
+// runtime and engine deserialized once per model, execution contexts are created per detector
+class TensorRTEngine
+{
+public:
+    ~TensorRTEngine()
+    {
+        delete engine;
+        delete runtime;
+    }
+
+    nvinfer1::IRuntime* runtime = nullptr;
+    nvinfer1::ICudaEngine* engine = nullptr;
+};
+
 class TensorRT
 {
 public:
@@ -24,6 +41,7 @@ public:
 
     int get_model_width() { return input_w; }
     int get_model_height() { return input_h; }
+    int get_max_batch_size() { return max_batch_size; }
 
     nvinfer1::ICudaEngine* get_engine() { return engine; }
 
@@ -32,12 +50,16 @@ public:
     bool save_engine(const std::string& filename);
 protected:
     cudaStream_t stream;
-    nvinfer1::IRuntime* runtime;
-    nvinfer1::ICudaEngine* engine;
-    nvinfer1::IExecutionContext* context;
+    std::shared_ptr<TensorRTEngine> shared_engine; // shared through ModelRegistry
+    nvinfer1::IRuntime* runtime = nullptr;
+    nvinfer1::ICudaEngine* engine = nullptr;
+    nvinfer1::IExecutionContext* context = nullptr;
+    size_t engine_size = 0;
 
     int input_w;
     int input_h;
+    int max_batch_size = 1;
+    bool is_dynamic_batch = false;
     int num_detections;
     int detection_attribute_size;
     int num_classes = 80;
@@ -55,15 +77,21 @@ public:
     void infer();
     void preprocess(cv::Mat& image);
     void postprocess(std::vector<Detection>& output);
+
+    bool set_batch_size(int size);
+    void preprocess(cv::Mat& image, int batch_index);
+    void postprocess(std::vector<Detection>& output, int batch_index);
 private:
     void init();
 
+    int batch_size = 0;
+
     float* gpu_buffers[2];               
     float* cpu_output_buffer = nullptr;
 
-    std::vector<cv::Rect> boxes;
-    std::vector<int> class_ids;
-    std::vector<float> confidences;
+    cs::YoloDecoder<cs::YOLO_LAYOUT::YOLO_LAYOUT_V8> decoder;
+    cs::yolo_candidates candidates;
+    cs::NonMaxSuppression nms;
     std::vector<int> nms_result;
 
     std::vector<cv::Scalar> colors;
@@ -70,10 +70,21 @@ int TFYOLOv5ObjectDetector::init(object_detector_environment& env)
 {
     yolo_model.confThreshold = 0.30;
     yolo_model.nmsThreshold = 0.40;
-    yolo_model.nthreads = 4;
+    int threads = 0;
+    if (env.additional != nullptr) {
+        threads = env.additional->get<int>("tflite_threads", threads);
+        yolo_model.isUseXnnpack = env.additional->get<bool>("tflite_use_xnnpack", yolo_model.isUseXnnpack);
+        yolo_model.yoloVersion = env.additional->get<int>("yolo_version", yolo_model.yoloVersion);
+    }
+
+    // threads not set by the settings are taken from the process wide budget
+    budget_owner = env.model_path;
+    yolo_model.nthreads = ThreadBudget::get_instance()->assign(budget_owner, "tflite", threads);
 
     yolo_model.loadModel(env.model_path);
     yolo_model.getLabelsName(env.label_path, labels);
+    for (auto& label : labels)
+        label = trim(label);
 
     cout << "[TFYOLOv5ObjectDetector] Label Count: " << labels.size() << "\n" << endl;
 
@@ -87,7 +98,22 @@ int TFYOLOv5ObjectDetector::init(object_detector_environment& env)
 
 void TFYOLOv5ObjectDetector::clear()
 {
+    if (!budget_owner.empty()) {
+        ThreadBudget::get_instance()->release(budget_owner, "tflite");
+        budget_owner.clear();
+    }
+}
 
+void TFYOLOv5ObjectDetector::get_stage_durations(std::vector<std::pair<std::string, double>>& durations)
+{
+    YOLOV5Timings timings = yolo_model.getMeanTimings();
+    durations.clear();
+    if (timings.count == 0)
+        return;
+
+    durations.emplace_back("preprocess", timings.preprocess);
+    durations.emplace_back("inference", timings.inference);
+    durations.emplace_back("postprocess", timings.postprocess);
 }
 
 int TFYOLOv5ObjectDetector::detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw)
@@ -101,19 +127,17 @@ int TFYOLOv5ObjectDetector::detect(cv::cuda::GpuMat* input, int& current_id, boo
     return detect(&image, current_id, is_draw);
 }
 
-int TFYOLOv5ObjectDetector::detect(Mat* image, int& current_id, bool is_draw, std::list<DetectionItem*>* detections)
+int TFYOLOv5ObjectDetector::detect(Mat* image, int& current_id, bool is_draw, DetectionSpan detections)
 {
     if (!image)
         return 0;
 
-    Mat detect;
-    image->copyTo(detect);
-
-    yolo_model.run(detect, out_pred);
+    // run doesn't modify the image, crops and frames are shared without copying
+    yolo_model.run(*image, out_pred);
 
-    auto boxes = out_pred.boxes;
-    auto scores = out_pred.scores;
-    auto _labels = out_pred.labels;
+    const auto& boxes = out_pred.boxes;
+    const auto& scores = out_pred.scores;
+    const auto& _labels = out_pred.labels;
     clear_last_detections();
 
     for (int i = 0; i < boxes.size(); i++)
@@ -122,15 +146,15 @@ int TFYOLOv5ObjectDetector::detect(Mat* image, int& current_id, bool is_draw, st
         auto box = boxes[i];
         auto score = scores[i];
 
-        DetectionItem* item = new DetectionItem();
-        item->color = color;
-        if (check_rule(ind, score, item->color)) {
-            DetectionItem* item = new DetectionItem();
+        cv::Scalar item_color = color;
+        if (check_rule(ind, score, item_color)) {
+            DetectionItem* item = create_detection();
+            item->color = item_color;
             item->id = current_id;
             item->detector_id = id;
             current_id++;
             item->kind = ObjectDetectorKind::OBJECT_DETECTOR_TENSORFLOW_YOLOv5;
-            item->label = trim(labels[ind]);
+            item->set_label(get_label(ind));
             item->class_id = ind;
             item->score = score;
             item->box.x = box.x;
@@ -143,14 +167,15 @@ int TFYOLOv5ObjectDetector::detect(Mat* image, int& current_id, bool is_draw, st
 
             if (is_draw) {
                 cv::rectangle(*image, box, cv::Scalar(255, 0, 0), 2);
-                cv::putText(*image, labels[ind], cv::Point(box.x, box.y), cv::FONT_HERSHEY_COMPLEX, 1.0, cv::Scalar(255, 0, 0), 1, cv::LINE_AA);
+                cv::putText(*image, item->get_label(), cv::Point(box.x, box.y), cv::FONT_HERSHEY_COMPLEX, 1.0, cv::Scalar(255, 0, 0), 1, cv::LINE_AA);
             }
         }
-        else
-            delete item;
     }
 
-    out_pred = {};
+    // capacity is kept for the next frame
+    out_pred.boxes.clear();
+    out_pred.scores.clear();
+    out_pred.labels.clear();
 
     return 1;
 }
@@ -26,6 +26,7 @@
 #include "yolov5_tflite.h"
 #include "IObjectDetector.h"
 #include "JsonWrapper.h"
+#include "ThreadBudget.h"
 
 namespace cs
 {
@@ -38,12 +39,14 @@ namespace cs
 		virtual int init(object_detector_environment& env) override;
 
 		virtual void clear();
-		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, std::list<DetectionItem*>* detections = nullptr) override;
+		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, DetectionSpan detections = {}) override;
 		virtual int detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw = false) override;
 		virtual int detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw = false) override { return 0; };
+		virtual void get_stage_durations(std::vector<std::pair<std::string, double>>& durations) override;
 	private:
 		Prediction out_pred;
 		YOLOV5 yolo_model;
+		std::string budget_owner = ""; // model path the threads are assigned to
 	};
 }
 
@@ -1,5 +1,12 @@
 #include "yolov5_tflite.h"
 
+YOLOV5::~YOLOV5()
+{
+    _interpreter.reset();
+    if (_delegate != nullptr)
+        TfLiteXNNPackDelegateDelete(_delegate);
+}
+
 void YOLOV5::getLabelsName(std::string path, std::vector<std::string> &labelNames)
 {
     // Open the File
@@ -21,22 +28,43 @@ void YOLOV5::getLabelsName(std::string path, std::vector<std::string> &labelName
 
 void YOLOV5::loadModel(const std::string path)
 {
-    _model = tflite::FlatBufferModel::BuildFromFile(path.c_str());
+    _model = cs::ModelRegistry::get_instance()->acquire<tflite::FlatBufferModel>("tflite:" + path, [&path](size_t& bytes) {
+        std::shared_ptr<tflite::FlatBufferModel> model = tflite::FlatBufferModel::BuildFromFile(path.c_str());
+        if (model != nullptr && model->allocation() != nullptr)
+            bytes = model->allocation()->bytes();
+        return model;
+    });
     if (_model == nullptr) {
         std::cout << "\nFailed to load the model: " << path << std::endl;
         return;
     }
     else {
-        std::cout << "\nModel: " << path << " loaded successfully." << std::endl;
+        std::cout << "\nModel: " << path << " loaded successfully, users: " << _model.use_count() << std::endl;
     }
 
-    tflite::ops::builtin::BuiltinOpResolver resolver;
-    tflite::InterpreterBuilder(*_model.get(), resolver)(&_interpreter);
+    // the delegate is applied explicitly to control its threads
+    tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+    tflite::InterpreterBuilder builder(*_model.get(), resolver);
+    builder.SetNumThreads(nthreads);
+    builder(&_interpreter);
     if (_interpreter == nullptr) {
         std::cerr << "Failed to initiate the interpreter" << std::endl;
         exit(-1);
     }
 
+    if (isUseXnnpack) {
+        TfLiteXNNPackDelegateOptions xnnpack_options = TfLiteXNNPackDelegateOptionsDefault();
+        xnnpack_options.num_threads = nthreads;
+        _delegate = TfLiteXNNPackDelegateCreate(&xnnpack_options);
+        if (_delegate == nullptr || _interpreter->ModifyGraphWithDelegate(_delegate) != kTfLiteOk) {
+            // unsupported graphs are executed by the builtin kernels
+            std::cout << "\nXNNPACK delegate isn`t applied, builtin kernels are used.\n";
+        }
+        else {
+            std::cout << "\nXNNPACK delegate applied, threads: " << nthreads << std::endl;
+        }
+    }
+
     TfLiteStatus status = _interpreter->AllocateTensors();
     if (status != kTfLiteOk) {
         std::cout << "\nFailed to allocate the memory for tensors.\n" << std::endl;
@@ -60,104 +88,136 @@ void YOLOV5::loadModel(const std::string path)
     _in_width = dims->data[2];
     _in_channels = dims->data[3];
     _in_type = _interpreter->tensor(_input)->type;
-    _input_8 = _interpreter->typed_tensor<uint8_t>(_input);
+    _input_data = _interpreter->tensor(_input)->data.raw;
+
+    cs::tensor_pack_params pack;
+    pack.width = _in_width;
+    pack.height = _in_height;
+    pack.layout = cs::TENSOR_LAYOUT::TENSOR_LAYOUT_NHWC;
+    pack.resize = cs::TENSOR_RESIZE::TENSOR_RESIZE_STRETCH;
+    if (_in_type == kTfLiteFloat32) {
+        pack.type = cs::TENSOR_TYPE::TENSOR_TYPE_FLOAT32;
+    }
+    else {
+        // quantized inputs take the pixels as they are unless the tensor says otherwise
+        auto quant = _interpreter->tensor(_input)->params;
+        pack.type = _in_type == kTfLiteInt8 ? cs::TENSOR_TYPE::TENSOR_TYPE_INT8 : cs::TENSOR_TYPE::TENSOR_TYPE_UINT8;
+        if (quant.scale > 0) {
+            pack.quant_scale = quant.scale;
+            pack.zero_point = quant.zero_point;
+        }
+    }
+    _packer.set_params(pack);
 
-    std::cout << "[yolov5_tflite] TFLite model sizes: " << _in_width << "x" << _in_height << " channels: " << _in_channels << " Type: " << _in_type << std::endl;
+    if (!initOutput()) {
+        _interpreter.reset();
+        return;
+    }
 
-    //_interpreter->SetNumThreads(nthreads);
+    std::cout << "[yolov5_tflite] TFLite model sizes: " << _in_width << "x" << _in_height << " channels: " << _in_channels << " Type: " << _in_type << std::endl;
 }
 
-void YOLOV5::preprocess(cv::Mat &image)
+YOLOV5Timings YOLOV5::getMeanTimings()
 {
-    cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
-    cv::resize(image, image, cv::Size(_in_height, _in_width), cv::INTER_CUBIC);
-    image.convertTo(image, CV_8U);
-}  
-
-template <typename T>
-void YOLOV5::fill(T *in, cv::Mat &src)
-{
-    int n = 0, nc = src.channels(), ne = src.elemSize();
-    for (int y = 0; y < src.rows; ++y)
-        for (int x = 0; x < src.cols; ++x)
-            for (int c = 0; c < nc; ++c)
-                in[n++] = src.data[y * src.step + x * ne + c];
+    std::lock_guard<std::mutex> lock(_timings_mutex);
+    YOLOV5Timings result = _timings_sum;
+    if (result.count > 0) {
+        result.preprocess /= result.count;
+        result.inference /= result.count;
+        result.postprocess /= result.count;
+    }
+    return result;
 }
 
-std::vector<std::vector<float>> YOLOV5::tensorToVector2D(TfLiteTensor *pOutputTensor, const int &row, const int &colum)
+bool YOLOV5::initOutput()
 {
-    auto scale = pOutputTensor->params.scale;
-    auto zero_point = pOutputTensor->params.zero_point;
-    std::vector<std::vector<float>> v;
-    for (int32_t i = 0; i < row; i++)
-    {
-        std::vector<float> _tem;
-        for (int j = 0; j < colum; j++)
-        {
-            float val_float = (((int32_t)pOutputTensor->data.uint8[i * colum + j]) - zero_point) * scale;
-            _tem.push_back(val_float);
-        }
-        v.push_back(_tem);
+    if (_interpreter->outputs().size() == 0) {
+        std::cout << "\nThe model doesn`t have any outputs.\n";
+        return false;
     }
-    return v;
-}
 
-void YOLOV5::nonMaximumSupprition(
-    std::vector<std::vector<float>> &predV,
-    const int &row,
-    const int &colum,
-    std::vector<cv::Rect> &boxes,
-    std::vector<float> &confidences,
-    std::vector<int> &classIds,
-    std::vector<int> &indices)
+    _output = _interpreter->outputs()[0];
+    const TfLiteTensor *tensor = _interpreter->tensor(_output);
+    if (tensor->dims->size != 3) {
+        std::cout << "\nUnsupported output of the model, [1, anchors, attributes] or [1, attributes, anchors] is expected.\n";
+        return false;
+    }
+
+    _out_type = tensor->type;
+    if (_out_type != kTfLiteFloat32 && _out_type != kTfLiteUInt8 && _out_type != kTfLiteInt8) {
+        std::cout << "\nUnsupported type of the output: " << _out_type << std::endl;
+        return false;
+    }
+
+    _out_quant = cs::yolo_quantization();
+    if (_out_type != kTfLiteFloat32) {
+        _out_quant.scale = tensor->params.scale;
+        _out_quant.zero_point = tensor->params.zero_point;
+    }
+
+    int dim1 = tensor->dims->data[1];
+    int dim2 = tensor->dims->data[2];
+    if (yoloVersion == 5)
+        _decoder.set_layout(cs::YOLO_LAYOUT::YOLO_LAYOUT_V5);
+    else if (yoloVersion == 8 || yoloVersion == 11)
+        _decoder.set_layout(dim1 < dim2 ? cs::YOLO_LAYOUT::YOLO_LAYOUT_V8 : cs::YOLO_LAYOUT::YOLO_LAYOUT_V8_TRANSPOSED);
+    else
+        _decoder.set_layout(cs::YoloOutputDecoder::detect_layout(dim1, dim2, true));
+
+    _out_anchors = std::max(dim1, dim2);
+    _out_classes = std::min(dim1, dim2) - (_decoder.get_layout() == cs::YOLO_LAYOUT::YOLO_LAYOUT_V5 ? 5 : 4);
+
+    std::cout << "[yolov5_tflite] Output: " << dim1 << "x" << dim2 << " classes: " << _out_classes << " Type: " << _out_type << std::endl;
+
+    return _out_classes > 0;
+}
 
+// boxes of the output are normalized to the input
+void YOLOV5::postprocess(Prediction &out_pred)
 {
+    const TfLiteTensor *tensor = _interpreter->tensor(_output);
+
+    _candidates.clear();
+    switch (_out_type) {
+    case kTfLiteUInt8: _decoder.decode(tensor->data.uint8, _out_anchors, _out_classes, confThreshold, _out_quant, _candidates); break;
+    case kTfLiteInt8: _decoder.decode(tensor->data.int8, _out_anchors, _out_classes, confThreshold, _out_quant, _candidates); break;
+    default: _decoder.decode(tensor->data.f, _out_anchors, _out_classes, confThreshold, _candidates); break;
+    }
 
-    std::vector<cv::Rect> boxesNMS;
-    int max_wh = 40960;
-    std::vector<float> scores;
-    double confidence;
-    cv::Point classId;
+    cs::nms_params nms_settings;
+    nms_settings.score_threshold = confThreshold;
+    nms_settings.iou_threshold = nmsThreshold;
+    _nms.set_params(nms_settings);
+    _nms.run(_candidates, _indices);
 
-    for (int i = 0; i < row; i++)
+    out_pred.boxes.reserve(_indices.size());
+    out_pred.scores.reserve(_indices.size());
+    out_pred.labels.reserve(_indices.size());
+    for (int idx : _indices)
     {
-        if (predV[i][4] > confThreshold)
-        {
-            // height--> image.rows,  width--> image.cols;
-            int left = (predV[i][0] - predV[i][2] / 2) * _img_width;
-            int top = (predV[i][1] - predV[i][3] / 2) * _img_height;
-            int w = predV[i][2] * _img_width;
-            int h = predV[i][3] * _img_height;
-
-            for (int j = 5; j < colum; j++)
-            {
-                // # conf = obj_conf * cls_conf
-                scores.push_back(predV[i][j] * predV[i][4]);
-            }
-
-            cv::minMaxLoc(scores, 0, &confidence, 0, &classId);
-            scores.clear();
-            int c = classId.x * max_wh;
-            if (confidence > confThreshold)
-            {
-                boxes.push_back(cv::Rect(left, top, w, h));
-                confidences.push_back(confidence);
-                classIds.push_back(classId.x);
-                boxesNMS.push_back(cv::Rect(left, top, w, h));
-            }
-        }
+        out_pred.boxes.emplace_back(static_cast<int>(_candidates.x[idx] * _img_width), static_cast<int>(_candidates.y[idx] * _img_height),
+            static_cast<int>(_candidates.w[idx] * _img_width), static_cast<int>(_candidates.h[idx] * _img_height));
+        out_pred.scores.push_back(_candidates.scores[idx]);
+        out_pred.labels.push_back(_candidates.class_ids[idx]);
     }
-    cv::dnn::NMSBoxes(boxesNMS, confidences, confThreshold, nmsThreshold, indices);
 }
 
-void YOLOV5::run(cv::Mat frame, Prediction &out_pred)
+void YOLOV5::run(const cv::Mat& frame, Prediction &out_pred)
 {
+    if (_interpreter == nullptr)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
 
     _img_height = frame.rows;
     _img_width = frame.cols;
 
-    preprocess(frame);
-    fill(_input_8, frame);
+    // resize and colour conversion are written straight into the input tensor
+    if (!_packer.pack(frame.data, frame.step, frame.cols, frame.rows, frame.channels(), _input_data)) {
+        std::cout << "\nUnsupported input image: " << frame.cols << "x" << frame.rows << "x" << frame.channels() << std::endl;
+        return;
+    }
+    auto packed = std::chrono::steady_clock::now();
 
     // Inference
     TfLiteStatus status = _interpreter->Invoke();
@@ -166,27 +226,16 @@ void YOLOV5::run(cv::Mat frame, Prediction &out_pred)
         std::cout << "\nFailed to run inference!!\n";
         exit(1);
     }
+    auto inferred = std::chrono::steady_clock::now();
 
-    int _out = _interpreter->outputs()[0];
-    TfLiteIntArray *_out_dims = _interpreter->tensor(_out)->dims;
-    int _out_row   = _out_dims->data[1];   // 25200
-    int _out_colum = _out_dims->data[2];   // class number + 5 ---> 85     bbox cond class
-    // int _out_type  = _interpreter->tensor(_out)->type;
-
-    TfLiteTensor *pOutputTensor = _interpreter->tensor(_interpreter->outputs()[0]);
-    std::vector<std::vector<float>> predV = tensorToVector2D(pOutputTensor, _out_row, _out_colum);
- 
-    std::vector<int> indices;
-    std::vector<int> classIds;
-    std::vector<float> confidences;
-    std::vector<cv::Rect> boxes;
-
-    nonMaximumSupprition(predV, _out_row, _out_colum, boxes, confidences, classIds, indices);
+    postprocess(out_pred);
 
-    for (int i = 0; i < indices.size(); i++)
+    auto finished = std::chrono::steady_clock::now();
     {
-        out_pred.boxes.push_back(boxes[indices[i]]);
-        out_pred.scores.push_back(confidences[indices[i]]);
-        out_pred.labels.push_back(classIds[indices[i]]);
+        std::lock_guard<std::mutex> lock(_timings_mutex);
+        _timings_sum.preprocess += std::chrono::duration<double, std::milli>(packed - start).count();
+        _timings_sum.inference += std::chrono::duration<double, std::milli>(inferred - packed).count();
+        _timings_sum.postprocess += std::chrono::duration<double, std::milli>(finished - inferred).count();
+        _timings_sum.count++;
     }
-};
\ No newline at end of file
+};
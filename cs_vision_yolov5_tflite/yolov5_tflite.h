@@ -6,11 +6,14 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
+#include <mutex>
 
 //#ifdef __LINUX__
 #include <tensorflow/lite/model.h>
 #include <tensorflow/lite/interpreter.h>
 #include <tensorflow/lite/kernels/register.h>
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
 //#else
 //#include <tensorflow/lite/core/model.h>
 //#include <tensorflow/lite/core/interpreter.h>
@@ -23,6 +26,19 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/dnn.hpp>
 
+#include "TensorPacker.h"
+#include "NonMaxSuppression.h"
+#include "ModelRegistry.h"
+
+// mean durations of the stages of run, ms
+struct YOLOV5Timings
+{
+    double preprocess = 0;
+    double inference = 0;
+    double postprocess = 0;
+    int64_t count = 0;
+};
+
 struct Prediction
 {
     std::vector<cv::Rect> boxes;
@@ -33,10 +49,14 @@ struct Prediction
 class YOLOV5
 {
 public:
+    YOLOV5() {};
+    ~YOLOV5();
+
     // Take a model path as string
     void loadModel(const  std::string path);
     // Take an image and return a prediction
-    void run(cv::Mat image, Prediction &out_pred);
+    // image is not modified
+    void run(const cv::Mat& image, Prediction &out_pred);
 
     void getLabelsName(std::string path, std::vector<std::string> &labelNames);
 
@@ -44,15 +64,20 @@ public:
     float confThreshold = 0.5;
     float nmsThreshold = 0.5;
 
-    // number of threads
+    // number of threads of the interpreter and of the XNNPACK delegate, set before loadModel
     int nthreads = 4;
+    bool isUseXnnpack = true;
+    // 0 - by the output shape, 5 - YOLOv5, 8 and 11 - YOLOv8/YOLO11
+    int yoloVersion = 0;
+
+    YOLOV5Timings getMeanTimings();
 
     int _in_height;
     int _in_width;
     int _in_channels;
 private:
-    // model's
-    std::unique_ptr<tflite::FlatBufferModel> _model = nullptr;
+    // memory mapped model shared by the detectors with the same path, the interpreter is own
+    std::shared_ptr<tflite::FlatBufferModel> _model = nullptr;
     std::unique_ptr<tflite::Interpreter> _interpreter = nullptr;
     tflite::StderrReporter _error_reporter;
 
@@ -60,33 +85,35 @@ private:
     int _input;
     int _in_type;
 
-    // // parameters of interpreter's output
-    // int _out;
-    // TfLiteIntArray* _out_dims;
-    // int  _out_row;
-    // int  _out_colum;
-    // int  _out_type;                   =
+    // parameters of interpreter's output, [1, anchors, attributes] or [1, attributes, anchors]
+    int _output;
+    int _out_type;
+    int _out_anchors = 0;
+    int _out_classes = 0;
+    cs::yolo_quantization _out_quant;
 
     // parameters of original image
     int _img_height;
     int _img_width;
 
     // Input of the interpreter
-    uint8_t *_input_8;
-
-    // int _delegate_opt;
-    // TfLiteDelegate *_delegate;
-
-    template <typename T>
-    void fill(T *in, cv::Mat &src);
-    void preprocess(cv::Mat &image);
-    std::vector<std::vector<float>> tensorToVector2D(TfLiteTensor *pOutputTensor, const int &row, const int &colum);
-    void nonMaximumSupprition(
-        std::vector<std::vector<float>> &predV,
-        const int &row,
-        const int &colum,
-        std::vector<cv::Rect> &boxes,
-        std::vector<float> &confidences,
-        std::vector<int> &classIds,
-        std::vector<int> &indices);
+    void *_input_data = nullptr;
+
+    // applied to the interpreter, destroyed after it
+    TfLiteDelegate *_delegate = nullptr;
+
+    std::mutex _timings_mutex;
+    YOLOV5Timings _timings_sum;
+
+    // resize + BGR->RGB straight into the input tensor
+    cs::TensorPacker _packer;
+
+    // decoding straight from the output tensor (quantized ones too) and class-aware NMS, buffers are reused
+    cs::YoloOutputDecoder _decoder;
+    cs::yolo_candidates _candidates;
+    cs::NonMaxSuppression _nms;
+    std::vector<int> _indices;
+
+    bool initOutput();
+    void postprocess(Prediction &out_pred);
 };
\ No newline at end of file
@@ -38,20 +38,41 @@ OCVYOLOv8ObjectDetector::~OCVYOLOv8ObjectDetector()
 
 }
 
-int OCVYOLOv8ObjectDetector::init(const char* model_path, const char* label_path, const char* rules_path, bool is_use_gpu)
+int OCVYOLOv8ObjectDetector::init(object_detector_environment& env)
 {
-	return 0;
-}
-
-int OCVYOLOv8ObjectDetector::init(const char* model_path, const char* label_path, const char* rules_path, const char* input_tensor_name, const char* output_tensor_name, bool is_use_gpu)
-{
-	detector = new Inference(model_path, cv::Size(640, 640), label_path, is_use_gpu);
-
-    width = 640;
-    height = 640;
+	load_rules(env.rules_path.c_str());
+	load_labels(env.label_path.c_str());
+
+	InferenceParams params;
+	if (env.model_width > 0 && env.model_height > 0)
+		params.modelInputShape = cv::Size(env.model_width, env.model_height);
+	params.runWithCuda = env.is_use_gpu;
+	if (env.additional != nullptr) {
+		params.maxBatchSize = env.additional->get<int>("ocv_max_batch_size", params.maxBatchSize);
+		params.backend = env.additional->get<int>("ocv_backend", params.backend);
+		params.target = env.additional->get<int>("ocv_target", params.target);
+		params.modelScoreThreshold = env.additional->get<int>("conf_threshold_percent", 45) / 100.0f;
+		params.nms.iou_threshold = env.additional->get<int>("nms_threshold_percent", 50) / 100.0f;
+		params.nms.method = static_cast<NMS_METHOD>(env.additional->get<int>("nms_method", static_cast<int>(params.nms.method)));
+		params.nms.is_class_aware = env.additional->get<bool>("nms_class_aware", params.nms.is_class_aware);
+		params.nms.pre_top_k = env.additional->get<int>("nms_pre_top_k", params.nms.pre_top_k);
+		params.nms.max_detections = env.additional->get<int>("nms_max_detections", params.nms.max_detections);
+		params.nms.soft_sigma = env.additional->get<int>("nms_soft_sigma_percent", 50) / 100.0f;
+	}
+
+	try {
+		detector = make_unique<Inference>(env.model_path, params);
+	}
+	catch (const cv::Exception& e) {
+		cout << "[OCVYOLOv8] " << env.model_path << " isn`t loaded: " << e.what() << endl;
+		detector = nullptr;
+		return 0;
+	}
 
-	return 0;
+	width = params.modelInputShape.width;
+	height = params.modelInputShape.height;
 
+	return 1;
 }
 
 void OCVYOLOv8ObjectDetector::clear()
@@ -61,48 +82,78 @@ void OCVYOLOv8ObjectDetector::clear()
 
 int OCVYOLOv8ObjectDetector::detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw)
 {
-    return 1;
+	if (input == nullptr)
+		return 0;
+
+	cv::Mat img;
+	input->download(img);
+
+	return detect(&img, current_id, is_draw);
+}
+
+void OCVYOLOv8ObjectDetector::postprocess(cv::Mat* input, int& current_id, bool is_draw, int batch_index)
+{
+	for (auto& item : objects)
+	{
+		cv::Scalar item_color = color;
+		if (check_rule(item.class_id, item.confidence, item_color)) {
+			DetectionItem* detection = create_detection();
+			detection->color = item_color;
+			detection->id = current_id;
+			current_id++;
+
+			detection->detector_id = id;
+			detection->kind = ObjectDetectorKind::OBJECT_DETECTOR_OPENCV_YOLOv8;
+			detection->class_id = item.class_id;
+			detection->priority = get_rule_priority(item.class_id);
+			detection->set_label(get_label(item.class_id));
+			detection->score = item.confidence;
+			detection->box = item.box;
+			detection->neural_network_id = neural_network_id;
+			detection->batch_index = static_cast<int16_t>(batch_index);
+
+			last_detections.push_back(detection);
+
+			if (is_draw) {
+				cv::rectangle(*input, detection->box, cv::Scalar(255, 0, 0), 2);
+				cv::putText(*input, detection->get_label(), cv::Point(detection->box.x, detection->box.y), cv::FONT_HERSHEY_COMPLEX, 1.0, cv::Scalar(255, 0, 0), 1, cv::LINE_AA);
+			}
+		}
+	}
 }
 
-int OCVYOLOv8ObjectDetector::detect(cv::Mat* input, int& current_id, bool is_draw)
+int OCVYOLOv8ObjectDetector::detect(cv::Mat* input, int& current_id, bool is_draw, DetectionSpan detections)
 {
-    if (input == nullptr)
+	if (input == nullptr || detector == nullptr)
 		return 0;
 
-    std::vector<Detection> output = detector->runInference(*input);
-
-    for (auto& item : output)
-    {
-        DetectionItem* detection = new DetectionItem();
-        detection->color = color;
-        if (check_rule(item.class_id, item.confidence, detection->color)) {
-            detection->id = current_id;
-            current_id++;
-
-            detection->detector_id = id;
-            detection->kind = ObjectDetectorKind::OBJECT_DETECTOR_OPENCV_YOLOv8;
-            detection->class_id = item.class_id;
-            detection->label = trim(item.className);
-            detection->score = item.confidence;
-            detection->box = item.box;
-            detection->neural_network_id = neural_network_id;
-
-            last_detections.push_back(detection);
-
-            if (is_draw) {
-                cv::rectangle(*input, detection->box, cv::Scalar(255, 0, 0), 2);
-                cv::putText(*input, detection->label, cv::Point(detection->box.x, detection->box.y), cv::FONT_HERSHEY_COMPLEX, 1.0, cv::Scalar(255, 0, 0), 1, cv::LINE_AA);
-            }
-        }
-        else
-            delete detection;
-    }
-
-	return output.size() > 0;
+	clear_last_detections();
+
+	images.assign(1, input);
+	if (!detector->runInference(images))
+		return 0;
+
+	detector->getDetections(0, objects);
+	postprocess(input, current_id, is_draw);
+
+	return objects.size() > 0;
 }
 
 int OCVYOLOv8ObjectDetector::detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw)
 {
-	return 0;
-}
+	clear_last_detections();
 
+	if (detector == nullptr || input.empty() || static_cast<int>(input.size()) > detector->getMaxBatchSize())
+		return 0;
+
+	images.assign(input.begin(), input.end());
+	if (!detector->runInference(images))
+		return 0;
+
+	for (int i = 0; i < static_cast<int>(input.size()); i++) {
+		detector->getDetections(i, objects);
+		postprocess(input[i], current_id, is_draw, i);
+	}
+
+	return 1;
+}
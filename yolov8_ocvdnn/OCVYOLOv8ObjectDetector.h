@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <memory>
 #include "IObjectDetector.h"
 #include "inference.h"
 #include "JsonWrapper.h"
@@ -35,15 +36,17 @@ namespace cs
 		OCVYOLOv8ObjectDetector();
 		~OCVYOLOv8ObjectDetector();
 
-		virtual int init(const char* model_path, const char* label_path, const char* rules_path, bool is_use_gpu = false) override;
-		virtual int init(const char* model_path, const char* label_path, const char* rules_path, const char* input_tensor_name, const char* output_tensor_name, bool is_use_gpu = false) override;
-		virtual int init(void* param, bool is_use_gpu = false) { return 0; };
+		virtual int init(object_detector_environment& env) override;
 		virtual void clear() override;
-		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false) override;
+		virtual int detect(cv::Mat* input, int& current_id, bool is_draw = false, DetectionSpan detections = {}) override;
 		virtual int detect(cv::cuda::GpuMat* input, int& current_id, bool is_draw = false) override;
 		virtual int detect_batch(const std::vector<cv::Mat*>& input, int& current_id, bool is_draw = false) override;
+		virtual int get_model_batch_size() override { return detector != nullptr ? detector->getMaxBatchSize() : 1; };
 	private:
-		Inference* detector;
+		std::unique_ptr<Inference> detector = nullptr;
+		std::vector<const cv::Mat*> images;
+		std::vector<OCVDetection> objects;
+
+		void postprocess(cv::Mat* input, int& current_id, bool is_draw, int batch_index = -1);
 	};
 }
-
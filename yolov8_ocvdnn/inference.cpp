@@ -1,166 +1,115 @@
 #include "inference.h"
 
-Inference::Inference(const std::string &onnxModelPath, const cv::Size &modelInputShape, const std::string &classesTxtFile, const bool &runWithCuda)
+Inference::Inference(const std::string &onnxModelPath, const InferenceParams &params)
 {
     modelPath = onnxModelPath;
-    modelShape = modelInputShape;
-    classesPath = classesTxtFile;
-    cudaEnabled = runWithCuda;
+    this->params = params;
+    this->params.maxBatchSize = std::max(params.maxBatchSize, 1);
+    this->params.nms.score_threshold = params.modelScoreThreshold;
+    nms.set_params(this->params.nms);
 
     loadOnnxNetwork();
-    loadClassesFromFile(); 
+    initPacker();
 }
 
-std::vector<Detection> Inference::runInference(const cv::Mat &input)
+void Inference::initPacker()
 {
-    cv::Mat modelInput = input;
-    if (letterBoxForSquare && modelShape.width == modelShape.height)
-        modelInput = formatToSquare(modelInput);
-
-    cv::Mat blob;
-    cv::dnn::blobFromImage(modelInput, blob, 1.0/255.0, modelShape, cv::Scalar(), true, false);
-    net.setInput(blob);
-
-    std::vector<cv::Mat> outputs;
-    net.forward(outputs, net.getUnconnectedOutLayersNames());
+    cs::tensor_pack_params pack;
+    pack.width = params.modelInputShape.width;
+    pack.height = params.modelInputShape.height;
+    pack.layout = cs::TENSOR_LAYOUT::TENSOR_LAYOUT_NCHW;
+    pack.type = cs::TENSOR_TYPE::TENSOR_TYPE_FLOAT32;
+    // the frame is padded to a square at the top left corner, as the model was trained
+    if (letterBoxForSquare && pack.width == pack.height)
+        pack.resize = cs::TENSOR_RESIZE::TENSOR_RESIZE_LETTERBOX_TOP_LEFT;
+    else
+        pack.resize = cs::TENSOR_RESIZE::TENSOR_RESIZE_STRETCH;
+    pack.is_swap_rb = true;
+    pack.pad_value = 0;
+    packer.set_params(pack);
+
+    int blob_size[] = { params.maxBatchSize, 3, pack.height, pack.width };
+    blob.create(4, blob_size, CV_32F);
+    packInfo.resize(params.maxBatchSize);
+}
 
-    int rows = outputs[0].size[1];
-    int dimensions = outputs[0].size[2];
+bool Inference::runInference(const std::vector<const cv::Mat*> &input)
+{
+    batchSize = 0;
+    if (input.empty() || static_cast<int>(input.size()) > params.maxBatchSize)
+        return false;
 
-    bool yolov8 = false;
-    // yolov5 has an output of shape (batchSize, 25200, 85) (Num classes + box[x,y,w,h] + confidence[c])
-    // yolov8 has an output of shape (batchSize, 84,  8400) (Num classes + box[x,y,w,h])
-    if (dimensions > rows) // Check if the shape[2] is more than shape[1] (yolov8)
+    const size_t slot = packer.get_tensor_elements();
+    for (size_t i = 0; i < input.size(); ++i)
     {
-        yolov8 = true;
-        rows = outputs[0].size[2];
-        dimensions = outputs[0].size[1];
-
-        outputs[0] = outputs[0].reshape(1, dimensions);
-        cv::transpose(outputs[0], outputs[0]);
-    }
-    float *data = (float *)outputs[0].data;
+        const cv::Mat *src = input[i];
+        if (src == nullptr || src->empty())
+            return false;
 
-    float x_factor = modelInput.cols / modelShape.width;
-    float y_factor = modelInput.rows / modelShape.height;
-
-    std::vector<int> class_ids;
-    std::vector<float> confidences;
-    std::vector<cv::Rect> boxes;
-
-    for (int i = 0; i < rows; ++i)
-    {
-        if (yolov8)
+        if (src->channels() == 1)
         {
-            float *classes_scores = data+4;
-
-            cv::Mat scores(1, classes.size(), CV_32FC1, classes_scores);
-            cv::Point class_id;
-            double maxClassScore;
-
-            minMaxLoc(scores, 0, &maxClassScore, 0, &class_id);
-
-            if (maxClassScore > modelScoreThreshold)
-            {
-                confidences.push_back(maxClassScore);
-                class_ids.push_back(class_id.x);
-
-                float x = data[0];
-                float y = data[1];
-                float w = data[2];
-                float h = data[3];
-
-                int left = int((x - 0.5 * w) * x_factor);
-                int top = int((y - 0.5 * h) * y_factor);
-
-                int width = int(w * x_factor);
-                int height = int(h * y_factor);
-
-                boxes.push_back(cv::Rect(left, top, width, height));
-            }
+            cv::cvtColor(*src, bgr, cv::COLOR_GRAY2BGR);
+            src = &bgr;
         }
-        else // yolov5
-        {
-            float confidence = data[4];
 
-            if (confidence >= modelConfidenceThreshold)
-            {
-                float *classes_scores = data+5;
-
-                cv::Mat scores(1, classes.size(), CV_32FC1, classes_scores);
-                cv::Point class_id;
-                double max_class_score;
-
-                minMaxLoc(scores, 0, &max_class_score, 0, &class_id);
-
-                if (max_class_score > modelScoreThreshold)
-                {
-                    confidences.push_back(confidence);
-                    class_ids.push_back(class_id.x);
+        if (!packer.pack(src->data, src->step, src->cols, src->rows, src->channels(), blob.ptr<float>() + i * slot, &packInfo[i]))
+            return false;
+    }
 
-                    float x = data[0];
-                    float y = data[1];
-                    float w = data[2];
-                    float h = data[3];
+    // header over the first slots of the blob, no copy
+    int input_size[] = { static_cast<int>(input.size()), 3, params.modelInputShape.height, params.modelInputShape.width };
+    net.setInput(cv::Mat(4, input_size, CV_32F, blob.data));
+    net.forward(outputs, outputNames);
 
-                    int left = int((x - 0.5 * w) * x_factor);
-                    int top = int((y - 0.5 * h) * y_factor);
+    batchSize = static_cast<int>(input.size());
+    return !outputs.empty() && outputs[0].dims == 3;
+}
 
-                    int width = int(w * x_factor);
-                    int height = int(h * y_factor);
+void Inference::getDetections(int batchIndex, std::vector<OCVDetection> &detections)
+{
+    detections.clear();
+    if (batchIndex < 0 || batchIndex >= batchSize || batchIndex >= outputs[0].size[0])
+        return;
 
-                    boxes.push_back(cv::Rect(left, top, width, height));
-                }
-            }
-        }
+    int rows = outputs[0].size[1];
+    int dimensions = outputs[0].size[2];
+    const float *data = outputs[0].ptr<float>(batchIndex);
 
-        data += dimensions;
-    }
+    // yolov5 has an output of shape (batchSize, 25200, 85) (Num classes + box[x,y,w,h] + confidence[c])
+    // yolov8 has an output of shape (batchSize, 84,  8400) (Num classes + box[x,y,w,h])
+    decoder.set_layout(cs::YoloOutputDecoder::detect_layout(rows, dimensions, true));
+    int anchors = std::max(rows, dimensions);
+    int classes = std::min(rows, dimensions) - (decoder.get_layout() == cs::YOLO_LAYOUT::YOLO_LAYOUT_V5 ? 5 : 4);
 
-    std::vector<int> nms_result;
-    cv::dnn::NMSBoxes(boxes, confidences, modelScoreThreshold, modelNMSThreshold, nms_result);
+    candidates.clear();
+    decoder.decode(data, anchors, classes, params.modelScoreThreshold, candidates);
 
-    std::vector<Detection> detections{};
-    for (unsigned long i = 0; i < nms_result.size(); ++i)
+    const cs::tensor_pack_info &info = packInfo[batchIndex];
+    for (size_t i = 0; i < candidates.size(); ++i)
     {
-        int idx = nms_result[i];
-
-        Detection result;
-        result.class_id = class_ids[idx];
-        result.confidence = confidences[idx];
-
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<int> dis(100, 255);
-        result.color = cv::Scalar(dis(gen),
-                                  dis(gen),
-                                  dis(gen));
-
-        result.className = classes[result.class_id];
-        result.box = boxes[idx];
-
-        detections.push_back(result);
+        candidates.x[i] = (candidates.x[i] - info.pad_x) / info.scale_x;
+        candidates.y[i] = (candidates.y[i] - info.pad_y) / info.scale_y;
+        candidates.w[i] /= info.scale_x;
+        candidates.h[i] /= info.scale_y;
     }
 
-    return detections;
-}
+    nms.run(candidates, nmsResult);
 
-void Inference::loadClassesFromFile()
-{
-    std::ifstream inputFile(classesPath);
-    if (inputFile.is_open())
+    detections.reserve(nmsResult.size());
+    for (int idx : nmsResult)
     {
-        std::string classLine;
-        while (std::getline(inputFile, classLine))
-            classes.push_back(classLine);
-        inputFile.close();
+        OCVDetection result;
+        result.class_id = candidates.class_ids[idx];
+        result.confidence = candidates.scores[idx];
+        result.box = cv::Rect2f(candidates.x[idx], candidates.y[idx], candidates.w[idx], candidates.h[idx]);
+        detections.push_back(result);
     }
 }
 
 void Inference::loadOnnxNetwork()
 {
     net = cv::dnn::readNetFromONNX(modelPath);
-    if (cudaEnabled)
+    if (params.runWithCuda)
     {
         std::cout << "\nRunning on CUDA" << std::endl;
         net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
@@ -168,18 +117,10 @@ void Inference::loadOnnxNetwork()
     }
     else
     {
-        std::cout << "\nRunning on CPU" << std::endl;
-        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        std::cout << "\nRunning on backend: " << params.backend << " target: " << params.target << std::endl;
+        net.setPreferableBackend(params.backend);
+        net.setPreferableTarget(params.target);
     }
-}
 
-cv::Mat Inference::formatToSquare(const cv::Mat &source)
-{
-    int col = source.cols;
-    int row = source.rows;
-    int _max = MAX(col, row);
-    cv::Mat result = cv::Mat::zeros(_max, _max, CV_8UC3);
-    source.copyTo(result(cv::Rect(0, 0, col, row)));
-    return result;
+    outputNames = net.getUnconnectedOutLayersNames();
 }
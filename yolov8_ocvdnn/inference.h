@@ -3,51 +3,76 @@
 
 // Cpp native
 #include <fstream>
+#include <iostream>
+#include <algorithm>
 #include <vector>
 #include <string>
-#include <random>
 
 // OpenCV / DNN / Inference
 #include <opencv2/imgproc.hpp>
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
 
-struct Detection
+#include "TensorPacker.h"
+#include "YoloDecoder.h"
+#include "NonMaxSuppression.h"
+
+struct OCVDetection
 {
     int class_id{0};
-    std::string className{};
     float confidence{0.0};
-    cv::Scalar color{};
-    cv::Rect box{};
+    cv::Rect2f box{}; // in the coordinates of the source image
+};
+
+struct InferenceParams
+{
+    cv::Size modelInputShape{640, 640};
+    int maxBatchSize{1};        // > 1 only for models exported with a dynamic batch
+    bool runWithCuda{false};
+    // cv::dnn::Backend and cv::dnn::Target, used when CUDA is off
+    int backend{cv::dnn::DNN_BACKEND_OPENCV};
+    int target{cv::dnn::DNN_TARGET_CPU};
+    float modelScoreThreshold{0.45f};   // class score, multiplied by the objectness for YOLOv5
+    cs::nms_params nms;                 // score_threshold is modelScoreThreshold
 };
 
 class Inference
 {
 public:
-    Inference(const std::string &onnxModelPath, const cv::Size &modelInputShape = {640, 640}, const std::string &classesTxtFile = "", const bool &runWithCuda = true);
-    std::vector<Detection> runInference(const cv::Mat &input);
+    Inference(const std::string &onnxModelPath, const InferenceParams &params);
+
+    // images are packed into the slots of the input blob, the network is executed once for all of them
+    bool runInference(const std::vector<const cv::Mat*> &input);
+    void getDetections(int batchIndex, std::vector<OCVDetection> &detections);
+
+    int getMaxBatchSize() const { return params.maxBatchSize; }
+    cv::Size getModelInputShape() const { return params.modelInputShape; }
 
 private:
-    void loadClassesFromFile();
     void loadOnnxNetwork();
-    cv::Mat formatToSquare(const cv::Mat &source);
+    void initPacker();
 
     std::string modelPath{};
-    std::string classesPath{};
-    bool cudaEnabled{};
-
-    std::vector<std::string> classes;
-    //{ "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat", "traffic light", "fire hydrant", "stop sign", "parking meter", "bench", "bird", "cat", "dog", "horse", "sheep", "cow", "elephant", "bear", "zebra", "giraffe", "backpack", "umbrella", "handbag", "tie", "suitcase", "frisbee", "skis", "snowboard", "sports ball", "kite", "baseball bat", "baseball glove", "skateboard", "surfboard", "tennis racket", "bottle", "wine glass", "cup", "fork", "knife", "spoon", "bowl", "banana", "apple", "sandwich", "orange", "broccoli", "carrot", "hot dog", "pizza", "donut", "cake", "chair", "couch", "potted plant", "bed", "dining table", "toilet", "tv", "laptop", "mouse", "remote", "keyboard", "cell phone", "microwave", "oven", "toaster", "sink", "refrigerator", "book", "clock", "vase", "scissors", "teddy bear", "hair drier", "toothbrush" };
-
-    cv::Size2f modelShape{};
-
-    float modelConfidenceThreshold {0.25};
-    float modelScoreThreshold      {0.45};
-    float modelNMSThreshold        {0.50};
+    InferenceParams params;
 
     bool letterBoxForSquare = true;
 
+    // letterbox + resize + BGR->RGB + 1/255 straight into the blob, allocated once for the whole batch
+    cs::TensorPacker packer;
+    cv::Mat blob;
+    int batchSize{0};
+    std::vector<cs::tensor_pack_info> packInfo;
+
     cv::dnn::Net net;
+    std::vector<cv::String> outputNames;
+    std::vector<cv::Mat> outputs;
+
+    // decoding buffers, reused
+    cs::YoloOutputDecoder decoder;
+    cs::yolo_candidates candidates;
+    cs::NonMaxSuppression nms;
+    std::vector<int> nmsResult;
+    cv::Mat bgr;
 };
 
 #endif // INFERENCE_H